@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ros_sched_policy.h"
+#include "ros_sched_analysis.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Maximum number of tasks in a task-set description
+#define MAX_ANALYSIS_TASKS           256
+
+/*
+ *******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************
+*/
+
+
+// Tasks read from the description
+analysis_task_t g_tasks[MAX_ANALYSIS_TASKS];
+
+// Analysis results
+analysis_result_t g_results[MAX_ANALYSIS_TASKS];
+
+/*
+ *******************************************************************************
+ *                                    Main                                     *
+ *******************************************************************************
+*/
+
+
+int main (int argc, char *argv[])
+{
+	sched_policy_t policy = SCHED_POLICY_FIXED_PRIO;
+	FILE *file_p = stdin;
+	size_t len = 0;
+	int err;
+	bool depth_ok = true;
+
+	// Check argument count
+	if (argc < 2 || argc > 3) {
+		printf("%s <task-set-file|-> [fp|edf]\n"
+			"Each line: name period-us wcet-us prio deadline-us queue-depth\n",
+			argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Select policy
+	if (argc == 3) {
+		if (strcmp(argv[2], "edf") == 0) {
+			policy = SCHED_POLICY_EDF;
+		} else if (strcmp(argv[2], "fp") != 0) {
+			fprintf(stderr, "Unknown policy \"%s\"\n", argv[2]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	// Read the task set
+	if (strcmp(argv[1], "-") != 0 && (file_p = fopen(argv[1], "r")) == NULL) {
+		perror("fopen");
+		return EXIT_FAILURE;
+	}
+	err = read_analysis_tasks(file_p, g_tasks, MAX_ANALYSIS_TASKS, &len);
+	if (file_p != stdin) {
+		fclose(file_p);
+	}
+	if (err != 0) {
+		return EXIT_FAILURE;
+	}
+
+	// Analyze it
+	err = analyze_task_set(policy, g_tasks, len, g_results);
+
+	printf("Policy:\t\t\t\t%s\n", sched_policy_name(policy));
+	printf("Utilization:\t\t\t%.3f (bound %.3f)\n",
+		analysis_utilization(g_tasks, len),
+		sched_policy_utilization_bound(policy, len));
+	printf("%-16s %10s %10s %10s %4s %12s %5s %5s %5s\n", "task", "T(us)",
+		"C(us)", "D(us)", "prio", "R(us)", "ok", "depth", "need");
+
+	for (off_t i = 0; i < len; ++i) {
+		const task_params_t *params_p = &(g_tasks[i].params);
+		analysis_result_t *result_p = g_results + i;
+		char response[32] = "unbounded";
+
+		if (result_p->response_ns != ANALYSIS_UNBOUNDED) {
+			snprintf(response, sizeof(response), "%.1f",
+				(double)result_p->response_ns / NS_PER_USEC);
+		}
+
+		printf("%-16s %10" PRIu64 " %10" PRIu64 " %10" PRIu64 " %4u %12s %5s "
+			"%5zu %5s\n",
+			g_tasks[i].name, params_p->period_ns / NS_PER_USEC,
+			params_p->wcet_ns / NS_PER_USEC,
+			task_params_deadline(params_p) / NS_PER_USEC, params_p->prio,
+			response, result_p->schedulable ? "yes" : "NO",
+			g_tasks[i].queue_depth, result_p->depth_ok ? "ok" : "DROPS");
+
+		if (result_p->schedulable && !result_p->depth_ok) {
+			printf("%-16s needs a queue depth of at least %zu\n", "", 
+				result_p->required_depth);
+		}
+		depth_ok &= result_p->depth_ok;
+	}
+
+	printf("Schedulable:\t\t\t%s\n", (err == 0) ? "yes" : "no");
+	printf("Queue depths:\t\t\t%s\n", depth_ok ? "sufficient" : "insufficient");
+
+	return (err == 0 && depth_ok) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
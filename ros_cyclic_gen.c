@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ros_sched_analysis.h"
+#include "ros_cyclic_schedule.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Maximum number of tasks in a task-set description
+#define MAX_ANALYSIS_TASKS           256
+
+/*
+ *******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************
+*/
+
+
+// Tasks read from the description
+analysis_task_t g_tasks[MAX_ANALYSIS_TASKS];
+
+// Generated schedule table
+cyclic_table_t g_table;
+
+/*
+ *******************************************************************************
+ *                                    Main                                     *
+ *******************************************************************************
+*/
+
+
+int main (int argc, char *argv[])
+{
+	FILE *file_p = stdin, *out_p = stdout;
+	size_t len = 0;
+	uint64_t busy_ns = 0;
+	int err;
+
+	// Check argument count
+	if (argc < 2 || argc > 3) {
+		printf("%s <task-set-file|-> [table-file]\n"
+			"Each line: name period-us wcet-us prio deadline-us queue-depth\n"
+			"Task IDs in the table follow the order of the lines\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Read the task set
+	if (strcmp(argv[1], "-") != 0 && (file_p = fopen(argv[1], "r")) == NULL) {
+		perror("fopen");
+		return EXIT_FAILURE;
+	}
+	err = read_analysis_tasks(file_p, g_tasks, MAX_ANALYSIS_TASKS, &len);
+	if (file_p != stdin) {
+		fclose(file_p);
+	}
+	if (err != 0) {
+		return EXIT_FAILURE;
+	}
+
+	// Lay out the major frame
+	if ((err = build_cyclic_table(g_tasks, len, &g_table)) != 0) {
+		fprintf(stderr, "No table for this task set (%d)\n", err);
+		return EXIT_FAILURE;
+	}
+
+	// Write it out
+	if (argc == 3 && (out_p = fopen(argv[2], "w")) == NULL) {
+		perror("fopen");
+		return EXIT_FAILURE;
+	}
+	write_cyclic_table(out_p, &g_table);
+	if (out_p != stdout) {
+		fclose(out_p);
+	}
+
+	for (off_t i = 0; i < g_table.len; ++i) {
+		busy_ns += g_table.slots[i].wcet_ns;
+	}
+	fprintf(stderr, "%zu slots in a %" PRIu64 " us frame (%.1f%% reserved)\n",
+		g_table.len, g_table.major_frame_ns / NS_PER_USEC,
+		100.0 * busy_ns / g_table.major_frame_ns);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+#include "ros_cyclic_schedule.h"
+
+/*
+ *******************************************************************************
+ *                        Internal Function Definitions                        *
+ *******************************************************************************
+*/
+
+
+static uint64_t gcd (uint64_t a, uint64_t b)
+{
+	while (b != 0) {
+		uint64_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+int build_cyclic_table (const analysis_task_t *tasks, size_t len,
+	cyclic_table_t *table_p)
+{
+	uint64_t frame_ns = 1, t = 0;
+	uint64_t next_release[CYCLIC_MAX_SLOTS];
+	size_t jobs = 0;
+
+	// Parameter check
+	if (tasks == NULL || table_p == NULL || len == 0) {
+		return 1;
+	}
+
+	// Every task has at least one job per frame
+	if (len > CYCLIC_MAX_SLOTS) {
+		fprintf(stderr, "%s:%d: Too many tasks (max %d)\n",
+			__FILE__, __LINE__, CYCLIC_MAX_SLOTS);
+		return 3;
+	}
+
+	// The major frame is the hyperperiod of the task set
+	for (off_t i = 0; i < len; ++i) {
+		uint64_t period_ns = tasks[i].params.period_ns;
+		frame_ns = frame_ns / gcd(frame_ns, period_ns) * period_ns;
+		if (frame_ns > CYCLIC_MAX_FRAME_NS) {
+			fprintf(stderr, "%s:%d: Hyperperiod exceeds %" PRIu64 " us\n",
+				__FILE__, __LINE__, (uint64_t)CYCLIC_MAX_FRAME_NS / NS_PER_USEC);
+			return 3;
+		}
+		next_release[i] = 0;
+	}
+	for (off_t i = 0; i < len; ++i) {
+		jobs += frame_ns / tasks[i].params.period_ns;
+	}
+	if (jobs > CYCLIC_MAX_SLOTS) {
+		fprintf(stderr, "%s:%d: Too many jobs per frame (%zu > %d)\n",
+			__FILE__, __LINE__, jobs, CYCLIC_MAX_SLOTS);
+		return 3;
+	}
+
+	table_p->major_frame_ns = frame_ns;
+	table_p->len = 0;
+
+	// Lay out one job at a time: the released job with the earliest deadline
+	while (table_p->len < jobs) {
+		off_t pick = -1;
+		uint64_t pick_deadline = UINT64_MAX, earliest = UINT64_MAX;
+
+		for (off_t i = 0; i < len; ++i) {
+			uint64_t deadline_ns;
+			if (next_release[i] >= frame_ns) {
+				continue;
+			}
+			if (next_release[i] < earliest) {
+				earliest = next_release[i];
+			}
+			deadline_ns = next_release[i] +
+				task_params_deadline(&(tasks[i].params));
+			if (next_release[i] <= t && deadline_ns < pick_deadline) {
+				pick = i;
+				pick_deadline = deadline_ns;
+			}
+		}
+
+		// Idle until the next release
+		if (pick == -1) {
+			t = earliest;
+			continue;
+		}
+
+		table_p->slots[table_p->len++] = (cyclic_slot_t) {
+			.task_id   = pick,
+			.offset_ns = t,
+			.wcet_ns   = tasks[pick].params.wcet_ns
+		};
+		t += tasks[pick].params.wcet_ns;
+		next_release[pick] += tasks[pick].params.period_ns;
+
+		if (t > pick_deadline) {
+			fprintf(stderr, "%s:%d: Job of %s would finish at %" PRIu64
+				" us, past its deadline (%" PRIu64 " us)\n", __FILE__, __LINE__,
+				tasks[pick].name, t / NS_PER_USEC, pick_deadline / NS_PER_USEC);
+			return 2;
+		}
+	}
+
+	// The last job must leave the frame free for the next one to start
+	if (t > frame_ns) {
+		fprintf(stderr, "%s:%d: Jobs overrun the major frame\n",
+			__FILE__, __LINE__);
+		return 2;
+	}
+
+	return 0;
+}
+
+
+int read_cyclic_table (FILE *file_p, cyclic_table_t *table_p)
+{
+	char line[256];
+	size_t line_number = 0;
+	unsigned long frame_us = 0;
+
+	// Parameter check
+	if (file_p == NULL || table_p == NULL) {
+		return 1;
+	}
+
+	table_p->major_frame_ns = 0;
+	table_p->len = 0;
+
+	while (fgets(line, sizeof(line), file_p) != NULL) {
+		unsigned long offset_us, wcet_us;
+		long task_id;
+		char *p = line;
+		cyclic_slot_t *slot_p = NULL;
+
+		line_number++;
+
+		// Skip blank lines and comments
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+		if (*p == '#' || *p == '\n' || *p == '\0') {
+			continue;
+		}
+
+		if (sscanf(p, "frame %lu", &frame_us) == 1 && frame_us != 0 &&
+			table_p->major_frame_ns == 0) {
+			table_p->major_frame_ns = frame_us * NS_PER_USEC;
+			continue;
+		}
+
+		if (sscanf(p, "slot %ld %lu %lu", &task_id, &offset_us, &wcet_us) != 3 ||
+			task_id < 0 || table_p->major_frame_ns == 0 ||
+			offset_us * NS_PER_USEC >= table_p->major_frame_ns ||
+			(table_p->len > 0 && offset_us * NS_PER_USEC <
+			table_p->slots[table_p->len - 1].offset_ns)) {
+			fprintf(stderr, "%s:%d: Malformed slot on line %zu\n",
+				__FILE__, __LINE__, line_number);
+			return 2;
+		}
+
+		if (table_p->len >= CYCLIC_MAX_SLOTS) {
+			fprintf(stderr, "%s:%d: Too many slots (max %d)\n",
+				__FILE__, __LINE__, CYCLIC_MAX_SLOTS);
+			return 3;
+		}
+
+		slot_p = table_p->slots + table_p->len++;
+		slot_p->task_id   = task_id;
+		slot_p->offset_ns = offset_us * NS_PER_USEC;
+		slot_p->wcet_ns   = wcet_us * NS_PER_USEC;
+	}
+
+	return (table_p->major_frame_ns == 0 || table_p->len == 0) ? 2 : 0;
+}
+
+
+int write_cyclic_table (FILE *file_p, const cyclic_table_t *table_p)
+{
+	// Parameter check
+	if (file_p == NULL || table_p == NULL) {
+		return 1;
+	}
+
+	fprintf(file_p, "# major frame (us)\nframe %" PRIu64 "\n"
+		"# slot task offset-us wcet-us\n", table_p->major_frame_ns / NS_PER_USEC);
+	for (off_t i = 0; i < table_p->len; ++i) {
+		const cyclic_slot_t *slot_p = table_p->slots + i;
+		fprintf(file_p, "slot %ld %" PRIu64 " %" PRIu64 "\n", slot_p->task_id,
+			slot_p->offset_ns / NS_PER_USEC, slot_p->wcet_ns / NS_PER_USEC);
+	}
+
+	return 0;
+}
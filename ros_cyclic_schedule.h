@@ -0,0 +1,108 @@
+#if !defined(ROS_CYCLIC_SCHEDULE_H)
+#define ROS_CYCLIC_SCHEDULE_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 06/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Static schedule tables for time-triggered (cyclic executive) execution     *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "ros_sched_analysis.h"
+#include "ros_time.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Maximum number of slots in a major frame
+#define CYCLIC_MAX_SLOTS             512
+
+// Longest major frame (hyperperiod) a table may span
+#define CYCLIC_MAX_FRAME_NS          (10 * NS_PER_SEC)
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Structure: Describes a slot of a schedule table
+typedef struct {
+	off_t task_id;                        // Task released in the slot
+	uint64_t offset_ns;                   // Release offset in the major frame
+	uint64_t wcet_ns;                     // Time reserved for the job
+} cyclic_slot_t;
+
+
+// Structure: Describes a schedule table (slots ordered by offset)
+typedef struct {
+	uint64_t major_frame_ns;              // Length of the major frame
+	size_t len;                           // Number of slots
+	cyclic_slot_t slots[CYCLIC_MAX_SLOTS];  // Slots of the frame
+} cyclic_table_t;
+
+/*
+ *******************************************************************************
+ *                            Function Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Builds a schedule table for a task set. The major frame is the
+ *        hyperperiod of the tasks, and jobs are laid out back-to-back in
+ *        non-preemptive EDF order (the task index in the description is
+ *        the task ID in the table). Priorities are ignored
+ * @param tasks   Array of tasks (all released at offset zero)
+ * @param len     Number of tasks
+ * @param table_p Pointer to the table to fill in
+ * @return Zero on success; 1 on bad parameters; 2 if a job would finish
+ *         past its deadline; 3 if the hyperperiod or number of jobs is too
+ *         large for a table
+\*/
+int build_cyclic_table (const analysis_task_t *tasks, size_t len,
+	cyclic_table_t *table_p);
+
+
+/*\
+ * @brief Reads a schedule table. Blank lines and lines starting with '#' are
+ *        ignored; otherwise "frame <major-frame-us>" followed by one
+ *        "slot <task> <offset-us> <wcet-us>" line per slot, in offset order
+ * @param file_p  File to read from
+ * @param table_p Pointer to the table to fill in
+ * @return Zero on success; 1 on bad parameters; 2 on a malformed line or
+ *         a slot out of order (or outside the frame); 3 on too many slots
+\*/
+int read_cyclic_table (FILE *file_p, cyclic_table_t *table_p);
+
+
+/*\
+ * @brief Writes a schedule table in the format read by read_cyclic_table
+ * @param file_p  File to write to
+ * @param table_p Pointer to the table
+ * @return Zero on success; 1 on bad parameters
+\*/
+int write_cyclic_table (FILE *file_p, const cyclic_table_t *table_p);
+
+
+#endif
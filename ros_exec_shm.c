@@ -59,4 +59,23 @@ int unmap_shared_memory (const char *name, void *shm_ptr, size_t size, bool is_o
 	}
 
 	return err;
-}
\ No newline at end of file
+}
+
+
+void *shm_rebase (const void *shm_ptr, const void *remote_p)
+{
+	const exec_shm_header_t *header_p = (const exec_shm_header_t *)shm_ptr;
+	uintptr_t remote = (uintptr_t)remote_p;
+
+	// Parameter check
+	if (shm_ptr == NULL || remote_p == NULL) {
+		return NULL;
+	}
+
+	// Must lie within the map
+	if (remote < header_p->base || remote >= header_p->base + header_p->size) {
+		return NULL;
+	}
+
+	return (uint8_t *)shm_ptr + (remote - header_p->base);
+}
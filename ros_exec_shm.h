@@ -1,3 +1,6 @@
+#if !defined(ROS_EXEC_SHM_H)
+#define ROS_EXEC_SHM_H
+
 /*
  *******************************************************************************
  *                         (C) Copyright 2020 TU Delft                         *
@@ -23,6 +26,40 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/types.h>
+#include <stdint.h>
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Name of the executor's shared memory map
+#define EXEC_SHM_NAME                "ros_exec_shm"
+
+// Marks an initialized header (written last)
+#define EXEC_SHM_MAGIC               0x524f5345u
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Structure: Header at the start of the executor's map. Pointers stored in
+// the map are addresses of the executor's mapping, so attaching processes
+// rebase them (see shm_rebase)
+typedef struct {
+	volatile uint32_t magic;            // EXEC_SHM_MAGIC once initialized
+	pid_t executor_pid;                 // PID of the executor
+	uintptr_t base;                     // Address the executor mapped it at
+	size_t size;                        // Size of the map
+	off_t allocator_offset;             // Offset of the static allocator
+	off_t task_set_offset;              // Offset of the task set
+	off_t stats_offset;                 // Offset of the task set snapshot
+} exec_shm_header_t;
 
 /*
  *******************************************************************************
@@ -51,3 +88,14 @@ void *map_shared_memory (const char *mmap_name, size_t size, bool is_owner);
 \*/
 int unmap_shared_memory (const char *mmap_name, void *shm_ptr, size_t size,
  bool is_owner);
+
+/*\
+ * @brief Translates an address of the executor's mapping into this mapping
+ * @param shm_ptr   This process' mapping of the shared memory map
+ * @param remote_p  Address in the executor's mapping
+ * @return Local address; NULL if remote_p is NULL or outside the map
+\*/
+void *shm_rebase (const void *shm_ptr, const void *remote_p);
+
+
+#endif
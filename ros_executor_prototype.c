@@ -1,4 +1,4 @@
-#define _POSIX_SOURCE
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -11,11 +11,19 @@
 #include <signal.h>
 #include <inttypes.h>
 #include <math.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
 
+#include "ros_cyclic_schedule.h"
 #include "ros_exec_shm.h"
+#include "ros_log.h"
+#include "ros_perf.h"
 #include "ros_queue.h"
 #include "ros_task_set.h"
 #include "ros_static_allocator.h"
+#include "ros_time.h"
+#include "ros_trace.h"
 
 
 /*
@@ -25,7 +33,23 @@
 */
 
 
-#define MAX_PREEMPTABLE_TASKS        255
+// Maximum number of concurrent timers
+#define MAX_TIMER_COUNT              4096
+
+// Resolution of the timers
+#define TIMER_TICK_NS                NS_PER_MSEC
+
+// Maximum length of an input command
+#define MAX_INPUT_LENGTH             256
+
+// Delay before the first major frame of a schedule table starts
+#define CYCLIC_START_DELAY_MS        10
+
+// Longest interval between publications of the task set snapshot
+#define STATS_PUBLISH_MS             100
+
+// Space kept for the header of the shared memory map (cache line multiple)
+#define SHM_HEADER_SIZE              ((sizeof(exec_shm_header_t) + 63) & ~63)
 
 /*
  *******************************************************************************
@@ -37,11 +61,13 @@
 // Access semaphore 
 sem_t g_sem;
 
-// Shared memory pointer
+// Shared memory pointer (and the header describing it)
 void *g_shm;
+exec_shm_header_t *g_shm_header = NULL;
 
-// Allocator
+// Allocator (and the lock serializing it across processes)
 static_allocator_t *g_allocator;
+sem_t *g_alloc_sem = NULL;
 
 // Task set
 task_set_t *g_task_set;
@@ -49,6 +75,34 @@ task_set_t *g_task_set;
 // PID of self-process
 pid_t g_pid = -1;
 
+// Timer file-descriptor driving the task set timers
+int g_timer_fd = -1;
+
+// Signal file-descriptor reporting worker stops and budget exhaustion
+int g_signal_fd = -1;
+
+// Schedule table followed in time-triggered mode (and its timer)
+cyclic_table_t g_cyclic;
+int g_cyclic_fd = -1;
+bool g_cyclic_on = false;
+
+// Next slot of the table, and start of the current major frame
+off_t g_cyclic_slot = 0;
+uint64_t g_frame_start_ns = 0;
+
+// Task released from the table whose worker hasn't stopped yet (-1: none)
+off_t g_cyclic_pending = -1;
+
+// Slots released, and the worst lateness of a release
+uint64_t g_cyclic_released = 0;
+uint64_t g_cyclic_max_jitter_ns = 0;
+
+// Process printing the log records (-1: messages are printed directly)
+pid_t g_log_drainer = -1;
+
+// True if workers count the performance counters of their callbacks
+bool g_perf_on = false;
+
 
 /*
  *******************************************************************************
@@ -57,19 +111,44 @@ pid_t g_pid = -1;
 */
 
 
+static void alloc_lock (void)
+{
+	if (g_alloc_sem != NULL) {
+		while (sem_wait(g_alloc_sem) == -1 && errno == EINTR);
+	}
+}
+
+static void alloc_unlock (void)
+{
+	if (g_alloc_sem != NULL) {
+		sem_post(g_alloc_sem);
+	}
+}
+
 static uint8_t *alloc (size_t size)
 {
+	uint8_t *ptr = NULL;
+
 	if (g_allocator != NULL) {
-		return static_alloc(g_allocator, size);
-	} else {
-		return NULL;
+		alloc_lock();
+		ptr = static_alloc(g_allocator, size);
+		alloc_unlock();
 	}
+
+	return ptr;
 }
 
 static void release (uint8_t *ptr)
 {
+	size_t freed = 0;
+
 	if (g_allocator != NULL) {
+		alloc_lock();
+		freed = g_allocator->free_memory_size;
 		static_free(g_allocator, ptr);
+		freed = g_allocator->free_memory_size - freed;
+		alloc_unlock();
+		LOG(LOG_ALLOC_FREED, freed);
 	}
 }
 
@@ -109,31 +188,32 @@ void task_callback (void *data)
 		sum += isPrime(n);
 	}
 
-	printf("[%d] Sum = %d\n", g_pid, sum);
+	LOG(LOG_WORKER_SUM, g_pid, sum);
 }
 
 
 void task_routine (off_t task_id)
 {
-	task_t *task_p = NULL;
 	task_callback_t *callback_p = NULL;
+	void (*cb)(void *) = NULL;
+	perf_sample_t perf_start, perf_end;
+	bool drain = false;
+	off_t fused_task_id = -1;
 	int err;
-	void (*callback)(void *);
-
-	// Set the task
-	task_p = g_task_set->tasks + task_id;
 
 	do {
-		// Self suspend
-		kill(g_pid, SIGSTOP);
-
-		// **** Critical Section ****
-		// (set self as currently running task + extract callback data)
-		sem_wait(&(g_task_set->sem));
-		g_task_set->current_running_task_id = task_id;
+		// Self suspend (unless draining the queue)
+		if (!drain) {
+			kill(g_pid, SIGSTOP);
+		}
 
 		// Print wakeup
-		printf("[%d] Awoken!\n", g_pid);
+		TRACE(TRACE_WAKE, task_id, 0);
+		LOG(LOG_WORKER_AWOKEN, g_pid);
+
+		// **** Critical Section ****
+		// (mark callback as underway + extract callback data)
+		lock_task_set(g_task_set);
 
 		// Show task set
 		// printf("[%d] My task set:\n", g_pid);
@@ -143,31 +223,944 @@ void task_routine (off_t task_id)
 			g_task_set)) != 0) {
 			fprintf(stderr, "Process %d: Unable to dequeue data (%d)\n",
 				g_pid, err);
+			if (g_task_set->current_running_task_id == task_id) {
+				set_running_task(-1, g_task_set);
+			}
+			drain = false;
+			unlock_task_set(g_task_set);
 			continue;
 		}
-		sem_post(&(g_task_set->sem));
+
+		begin_task_callback(task_id, callback_p, g_task_set);
+
+		// Locate the task (the task array moves when tasks are registered)
+		cb = g_task_set->tasks[task_id].cb;
+		unlock_task_set(g_task_set);
 		// **** END critical section ****
 
-		// Execute the callback with the data
-		if (task_p->cb != NULL) {
-				task_p->cb(callback_p->callback_data);		
+		// Execute the callback with the data (counting it, if enabled)
+		if (g_perf_on) {
+			perf_read(&perf_start);
+		}
+		TRACE(TRACE_CB_START, task_id, callback_p->arrival_ns);
+		if (cb != NULL) {
+			cb(callback_p->callback_data);
+		}
+		TRACE(TRACE_CB_END, task_id, callback_p->arrival_ns);
+		if (g_perf_on) {
+			perf_read(&perf_end);
+			perf_delta(&perf_end, &perf_start, &perf_end);
+			task_stats_record_perf(task_id, &perf_end, g_task_set->stats);
 		}
 
 		// **** Critical Section ****
-		// Free callback data, and update as no longer active
-		sem_wait(&(g_task_set->sem));
-		if ((err = free_task_callback(callback_p, g_task_set)) != 0) {
+		// Update as no longer active (passing the output on, if chained)
+		lock_task_set(g_task_set);
+		complete_task_callback(task_id, callback_p, g_task_set);
+		if (forward_task_output(task_id, callback_p, &fused_task_id,
+			g_task_set) == 0) {
+			callback_p = NULL;
+		}
+
+		// Keep going while still the best choice (else yield)
+		drain = task_may_continue(task_id, g_task_set);
+		if (!drain && g_task_set->current_running_task_id == task_id) {
+			set_running_task(-1, g_task_set);
+		}
+
+		// Resume a fused successor without a trip through the executor
+		// (which must meter it instead if it has a budget, WCET or server)
+		if (fused_task_id != -1 && !drain) {
+			task_t *next_p = g_task_set->tasks + fused_task_id;
+			if (next_p->is_stopped && next_p->budget.budget_ns == 0 &&
+				next_p->crit.wcet_lo_ns == 0 && next_p->server == -1 &&
+				g_task_set->current_running_task_id == -1) {
+				next_p->is_stopped = false;
+				set_running_task(fused_task_id, g_task_set);
+				TRACE(TRACE_CONT, fused_task_id, next_p->pid);
+				kill(next_p->pid, SIGCONT);
+			}
+		}
+
+		// Free callback data (under the set lock, so the executor never
+		// stops or kills this worker while it holds the allocator lock)
+		if (callback_p != NULL &&
+			(err = free_task_callback(callback_p, g_task_set)) != 0) {
 			fprintf(stderr, "[%d]: Unable to free data (%d)\n",
 				g_pid, err);
 		}
-		g_task_set->current_running_task_id = -1;
-		printf("[%d] Execution complete!\n", g_pid);
-		sem_post(&(g_task_set->sem));
+		unlock_task_set(g_task_set);
 		// **** END critical sectin ****
+		LOG(LOG_WORKER_DONE, g_pid);
+
+	} while (1);
+}
+
+void pool_routine (off_t task_id)
+{
+	queue_t *queue_p = NULL;
+	task_callback_t *callback_p = NULL;
+	void (*cb)(void *) = NULL;
+	perf_sample_t perf_start, perf_end;
+	off_t fused_task_id = -1;
+	int err;
+
+	// The queue never moves (unlike the task)
+	lock_task_set(g_task_set);
+	queue_p = g_task_set->tasks[task_id].queue;
+	unlock_task_set(g_task_set);
+
+	do {
+		// Wait for work and claim it (the executor doesn't dispatch
+		// reentrant tasks)
+		queue_wait_for_data(queue_p);
+
+		// **** Critical Section ****
+		lock_task_set(g_task_set);
+
+		// Keep the claim while HI mode suspends the task
+		while (pool_task_suspended(task_id, g_task_set)) {
+			unlock_task_set(g_task_set);
+			wait_for_lo_mode(g_task_set);
+			lock_task_set(g_task_set);
+		}
+
+		// Another worker of the pool may have taken it (spending the claim)
+		if (queue_p->len == 0 || dequeue_claimed_callback_for_task(task_id,
+			&callback_p, g_task_set) != 0) {
+			unlock_task_set(g_task_set);
+			continue;
+		}
+		begin_task_callback(task_id, callback_p, g_task_set);
+		cb = g_task_set->tasks[task_id].cb;
+		unlock_task_set(g_task_set);
+		// **** END critical section ****
+
+		// Execute the callback (in parallel with the rest of the pool)
+		if (g_perf_on) {
+			perf_read(&perf_start);
+		}
+		TRACE(TRACE_CB_START, task_id, callback_p->arrival_ns);
+		if (cb != NULL) {
+			cb(callback_p->callback_data);
+		}
+		TRACE(TRACE_CB_END, task_id, callback_p->arrival_ns);
+		if (g_perf_on) {
+			perf_read(&perf_end);
+			perf_delta(&perf_end, &perf_start, &perf_end);
+			task_stats_record_perf(task_id, &perf_end, g_task_set->stats);
+		}
+
+		// **** Critical Section ****
+		lock_task_set(g_task_set);
+		complete_task_callback(task_id, callback_p, g_task_set);
+		if (forward_task_output(task_id, callback_p, &fused_task_id,
+			g_task_set) == 0) {
+
+			// Have the executor dispatch the successor
+			kill(getppid(), SIGCHLD);
+			callback_p = NULL;
+		}
+
+		// Free callback data (under the set lock, as in task_routine)
+		if (callback_p != NULL &&
+			(err = free_task_callback(callback_p, g_task_set)) != 0) {
+			fprintf(stderr, "[%d]: Unable to free data (%d)\n",
+				g_pid, err);
+		}
+		unlock_task_set(g_task_set);
+		// **** END critical section ****
 
 	} while (1);
 }
 
+// Forks a worker running the given task. Returns the PID (-1 on error)
+static pid_t spawn_task_worker (off_t task_id)
+{
+	pid_t pid;
+
+	// Don't duplicate buffered output in the worker
+	fflush(stdout);
+
+	if ((pid = fork()) == 0) {
+
+		// Update self PID (and log and trace into rings of its own)
+		g_pid = getpid();
+		log_attach();
+		if (g_perf_on) {
+			perf_open();
+		}
+#if defined(ROS_TRACE)
+		trace_attach(task_id);
+#endif
+
+		// Update task information
+		g_task_set->tasks[task_id].pid = g_pid;
+
+		// Update task callback
+		g_task_set->tasks[task_id].cb = task_callback;
+
+		// Run the task procedure
+		task_routine(task_id);
+
+		// Should never reach here
+		fprintf(stderr, "ILLEGAL POINT!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	// Register the task before it can be dispatched
+	if (pid > 0) {
+		g_task_set->tasks[task_id].pid = pid;
+		g_task_set->tasks[task_id].cb = task_callback;
+	} else {
+		perror("fork");
+	}
+
+	return pid;
+}
+
+// Forks or kills pool workers until a task has as many as its group needs
+static void match_task_pool (off_t task_id)
+{
+	task_t *task_p = g_task_set->tasks + task_id;
+	size_t pool_size = task_pool_size(task_id, g_task_set);
+	pid_t pid;
+
+	// Shrink the pool
+	while (task_p->pool_len > pool_size) {
+		kill(task_p->pool[--task_p->pool_len], SIGKILL);
+	}
+
+	// Grow the pool
+	while (task_p->pool_len < pool_size) {
+		fflush(stdout);
+		if ((pid = fork()) == 0) {
+			g_pid = getpid();
+			log_attach();
+			if (g_perf_on) {
+				perf_open();
+			}
+#if defined(ROS_TRACE)
+			trace_attach(task_id);
+#endif
+			pool_routine(task_id);
+			exit(EXIT_FAILURE);
+		} else if (pid == -1) {
+			perror("fork");
+			break;
+		}
+		task_p->pool[task_p->pool_len++] = pid;
+	}
+}
+
+// Kills all workers of a task
+static void kill_task_workers (task_t *task_p)
+{
+	if (task_p->pid > 0) {
+		kill(task_p->pid, SIGKILL);
+	}
+	for (off_t i = 0; i < task_p->pool_len; ++i) {
+		kill(task_p->pool[i], SIGKILL);
+	}
+}
+
+/*
+ *******************************************************************************
+ *                              Executor Routines                              *
+ *******************************************************************************
+*/
+
+
+// Arms the timer file-descriptor for the next timer expiry (must hold lock)
+static void arm_timer_fd (void)
+{
+	uint64_t expiry_ns = 0;
+	struct itimerspec spec = {0};
+
+	// Disarm if there is nothing to wait for
+	if (get_next_timer_expiry(&expiry_ns, g_task_set) == 0) {
+		spec.it_value = time_ns_to_timespec(expiry_ns);
+	}
+
+	if (timerfd_settime(g_timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+		perror("timerfd_settime");
+	}
+}
+
+// Arms the table timer for the next slot (absolute, so releases never drift)
+static void arm_cyclic_fd (void)
+{
+	struct itimerspec spec = {0};
+
+	if (g_cyclic_on) {
+		spec.it_value = time_ns_to_timespec(g_frame_start_ns +
+			g_cyclic.slots[g_cyclic_slot].offset_ns);
+	}
+
+	if (timerfd_settime(g_cyclic_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1) {
+		perror("timerfd_settime");
+	}
+}
+
+// Hands the tasks of the table back to the priority scan
+static void stop_cyclic_table (void)
+{
+	if (!g_cyclic_on) {
+		return;
+	}
+
+	for (off_t i = 0; i < g_cyclic.len; ++i) {
+		set_task_time_triggered(g_cyclic.slots[i].task_id, false, g_task_set);
+	}
+	g_cyclic_on = false;
+	g_cyclic_pending = -1;
+	arm_cyclic_fd();
+
+	printf("Released %" PRIu64 " slots, worst release jitter %" PRIu64
+		" us\n", g_cyclic_released, g_cyclic_max_jitter_ns / NS_PER_USEC);
+}
+
+// Follows a schedule table, starting a few milliseconds from now
+static int start_cyclic_table (const char *path)
+{
+	FILE *file_p = NULL;
+	int err;
+
+	stop_cyclic_table();
+
+	if ((file_p = fopen(path, "r")) == NULL) {
+		perror("fopen");
+		return 1;
+	}
+	err = read_cyclic_table(file_p, &g_cyclic);
+	fclose(file_p);
+	if (err != 0) {
+		return 2;
+	}
+
+	// Every slot must name a task
+	for (off_t i = 0; i < g_cyclic.len; ++i) {
+		if (set_task_time_triggered(g_cyclic.slots[i].task_id, true,
+			g_task_set) != 0) {
+			g_cyclic_on = true;
+			stop_cyclic_table();
+			return 3;
+		}
+	}
+
+	g_cyclic_on = true;
+	g_cyclic_slot = 0;
+	g_cyclic_pending = -1;
+	g_cyclic_released = g_cyclic_max_jitter_ns = 0;
+	g_frame_start_ns = (time_now_ns() / NS_PER_MSEC + CYCLIC_START_DELAY_MS) *
+		NS_PER_MSEC;
+	arm_cyclic_fd();
+
+	return 0;
+}
+
+// Resumes a task outright (preempting whatever runs), bypassing the scan
+static void run_task_now (off_t task_id)
+{
+	off_t running_task_id = g_task_set->current_running_task_id;
+
+	TRACE(TRACE_SCHEDULE, task_id, running_task_id);
+	if (running_task_id != -1) {
+		TRACE(TRACE_STOP, running_task_id,
+			g_task_set->tasks[running_task_id].pid);
+		kill(g_task_set->tasks[running_task_id].pid, SIGSTOP);
+		stop_task_budget(running_task_id, g_task_set);
+		set_running_task(-1, g_task_set);
+	}
+
+	g_task_set->tasks[task_id].is_stopped = false;
+	set_running_task(task_id, g_task_set);
+	TRACE(TRACE_CONT, task_id, g_task_set->tasks[task_id].pid);
+	kill(g_task_set->tasks[task_id].pid, SIGCONT);
+}
+
+// Preempts the running task if a higher priority task is ready
+static void dispatch_highest_prio_task (void)
+{
+	off_t running_task_id = -1;
+	int task_to_run = -1;
+
+	// **** Critical section ****
+	lock_task_set(g_task_set);
+
+	// A job released from the schedule table keeps the CPU until it
+	// completes, and goes first once its worker has stopped
+	running_task_id = g_task_set->current_running_task_id;
+	if ((running_task_id != -1 &&
+		g_task_set->tasks[running_task_id].time_triggered) ||
+		g_cyclic_pending != -1) {
+		if (g_cyclic_pending != -1 &&
+			g_task_set->tasks[g_cyclic_pending].is_stopped) {
+			run_task_now(g_cyclic_pending);
+			g_cyclic_pending = -1;
+		}
+		unlock_task_set(g_task_set);
+		return;
+	}
+
+	// Find highest priority task
+	task_to_run = get_highest_prio_task_index(g_task_set);
+
+	// Extract running task ID
+	running_task_id = g_task_set->current_running_task_id;
+
+	// Nothing changes if the running task remains the best choice
+	if (task_to_run == running_task_id) {
+		unlock_task_set(g_task_set);
+		return;
+	}
+
+	// Print update
+	TRACE(TRACE_SCHEDULE, task_to_run, running_task_id);
+	LOG(LOG_DISPATCH, running_task_id, task_to_run);
+
+	// Signal current running task to stop if exists (and charge its budget)
+	if (running_task_id != -1) {
+		TRACE(TRACE_STOP, running_task_id,
+			g_task_set->tasks[running_task_id].pid);
+		kill(g_task_set->tasks[running_task_id].pid, SIGSTOP);
+		stop_task_budget(running_task_id, g_task_set);
+		set_running_task(-1, g_task_set);
+	}
+
+	// Signal task to run to run (once its worker is known to have stopped)
+	if (task_to_run != -1 && g_task_set->tasks[task_to_run].is_stopped) {
+		g_task_set->tasks[task_to_run].is_stopped = false;
+		set_running_task(task_to_run, g_task_set);
+		start_task_budget(task_to_run, g_task_set);
+		arm_task_overrun(task_to_run, g_task_set);
+		TRACE(TRACE_CONT, task_to_run, g_task_set->tasks[task_to_run].pid);
+		kill(g_task_set->tasks[task_to_run].pid, SIGCONT);
+	}
+
+	// Switching tasks may (dis)arm a server depletion timer
+	arm_timer_fd();
+
+	unlock_task_set(g_task_set);
+	// **** END critical section ****
+}
+
+// Records stopped workers and budget exhaustion, then dispatches
+static void on_signal (void)
+{
+	struct signalfd_siginfo info;
+	pid_t pid;
+	int status;
+
+	// **** Critical section ****
+	lock_task_set(g_task_set);
+
+	// Charge tasks whose budget timer expired (marks them exhausted), and
+	// check HI-criticality jobs that may have overrun their LO-mode WCET
+	while (read(g_signal_fd, &info, sizeof(info)) == sizeof(info)) {
+		if (info.ssi_signo == TASK_OVERRUN_SIGNAL) {
+			check_task_overrun(info.ssi_int, g_task_set);
+			continue;
+		}
+		if (info.ssi_signo != TASK_BUDGET_SIGNAL) {
+			continue;
+		}
+		stop_task_budget(info.ssi_int, g_task_set);
+		if (info.ssi_int == g_task_set->current_running_task_id) {
+			start_task_budget(info.ssi_int, g_task_set);
+		}
+	}
+
+	// Record stopped workers, charging the budget of the task they ran
+	while ((pid = waitpid(-1, &status, WNOHANG | WUNTRACED)) > 0) {
+		if (!WIFSTOPPED(status)) {
+			continue;
+		}
+		for (off_t i = 0; i < g_task_set->len; ++i) {
+			if (g_task_set->tasks[i].pid == pid) {
+				g_task_set->tasks[i].is_stopped = true;
+				stop_task_budget(i, g_task_set);
+			}
+		}
+	}
+
+	unlock_task_set(g_task_set);
+	// **** END critical section ****
+
+	dispatch_highest_prio_task();
+}
+
+// Enqueues callbacks for expired timers, then dispatches
+static void on_timer (void)
+{
+	uint64_t expirations;
+	int fired;
+
+	// Acknowledge the timer file-descriptor
+	if (read(g_timer_fd, &expirations, sizeof(expirations)) == -1) {
+		return;
+	}
+
+	// **** Critical section ****
+	lock_task_set(g_task_set);
+	fired = fire_task_set_timers(time_now_ns(), g_task_set);
+	arm_timer_fd();
+	unlock_task_set(g_task_set);
+	// **** END critical section ****
+
+	if (fired > 0) {
+		dispatch_highest_prio_task();
+	}
+}
+
+// Releases the task of the due slot of the schedule table
+static void on_cyclic (void)
+{
+	uint64_t expirations, now_ns;
+	cyclic_slot_t *slot_p = NULL;
+	task_timer_event_t event;
+	int err;
+
+	// Acknowledge the timer file-descriptor
+	if (read(g_cyclic_fd, &expirations, sizeof(expirations)) == -1) {
+		return;
+	}
+
+	// **** Critical section ****
+	lock_task_set(g_task_set);
+
+	if (!g_cyclic_on) {
+		unlock_task_set(g_task_set);
+		return;
+	}
+
+	// Account how late the release is
+	slot_p = g_cyclic.slots + g_cyclic_slot;
+	event = (task_timer_event_t) {
+		.timer_id  = g_cyclic_slot,
+		.expiry_ns = g_frame_start_ns + slot_p->offset_ns
+	};
+	now_ns = time_now_ns();
+	if (now_ns - event.expiry_ns > g_cyclic_max_jitter_ns) {
+		g_cyclic_max_jitter_ns = now_ns - event.expiry_ns;
+	}
+	g_cyclic_released++;
+
+	// Release the job and run it (unless the previous one overran)
+	if ((err = enqueue_callback_for_task(slot_p->task_id, 0, sizeof(event),
+		&event, g_task_set)) != 0) {
+		fprintf(stderr, "Err: Slot %ld dropped a callback (%d)\n",
+			g_cyclic_slot, err);
+	} else if (g_task_set->current_running_task_id == slot_p->task_id) {
+		fprintf(stderr, "Err: Task %ld overran its slot\n", slot_p->task_id);
+	} else if (g_task_set->tasks[slot_p->task_id].is_stopped) {
+		run_task_now(slot_p->task_id);
+	} else {
+		g_cyclic_pending = slot_p->task_id;
+	}
+
+	// Move on to the next slot (and frame)
+	if (++g_cyclic_slot == g_cyclic.len) {
+		g_cyclic_slot = 0;
+		g_frame_start_ns += g_cyclic.major_frame_ns;
+	}
+	arm_cyclic_fd();
+
+	unlock_task_set(g_task_set);
+	// **** END critical section ****
+}
+
+// Handles a single command line
+static void on_command (char *input)
+{
+	char *dummy_data = "Foo";
+	off_t task_select = -1, timer_id = -1, topic_id = -1, group_id = -1;
+	off_t next_task_id = -1, chain_id = -1, server_id = -1;
+	char name[TASK_SERVER_NAME_LENGTH], path[MAX_INPUT_LENGTH];
+	int offset = 0, matched = 0;
+	double high = 0.0, low = 0.0;
+	size_t pool_size = 0;
+	int err, prio_select = -1;
+	unsigned long ms = 0, budget_ms = 0;
+	unsigned long period_us = 0, wcet_us = 0, deadline_us = 0;
+	char action = '\0', mode = '\0';
+
+	// **** Critical section ****
+	lock_task_set(g_task_set);
+
+	if (sscanf(input, "pub %ld %d", &topic_id, &prio_select) == 2) {
+		size_t delivered = 0;
+
+		// Publish one shared payload to all subscribers
+		if ((err = publish_callback(topic_id, prio_select,
+			strlen(dummy_data) + 1, dummy_data, &delivered, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to publish (%d)\n", err);
+		} else {
+			printf("Okay, published on topic %ld to %zu tasks\n", topic_id,
+				delivered);
+		}
+
+	} else if (sscanf(input, "sub %ld %ld", &task_select, &topic_id) == 2 ||
+		sscanf(input, "unsub %ld %ld", &task_select, &topic_id) == 2) {
+
+		// Change a topic subscription
+		if ((err = subscribe_task(task_select, topic_id, input[0] == 's',
+			g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to change subscription (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "p %ld %d %lu", &task_select, &prio_select, &ms) == 3 ||
+		sscanf(input, "o %ld %d %lu", &task_select, &prio_select, &ms) == 3) {
+		uint64_t period_ns = (input[0] == 'p') ? ms * NS_PER_MSEC : 0;
+
+		// Add a timer
+		if ((err = add_timer_for_task(task_select, prio_select, 
+			ms * NS_PER_MSEC, period_ns, &timer_id, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to add timer (%d)\n", err);
+		} else {
+			printf("Okay, timer %ld releases task %ld at prio %d after %lu ms\n",
+				timer_id, task_select, prio_select, ms);
+		}
+		arm_timer_fd();
+
+	} else if (sscanf(input, "b %ld %lu %lu", &task_select, &budget_ms, &ms) 
+		== 3) {
+		task_budget_action_t budget_action = (strchr(input, 's') != NULL) ?
+			TASK_BUDGET_SUSPEND : TASK_BUDGET_DEMOTE;
+
+		// Assign a CPU budget
+		if ((err = set_task_budget(task_select, budget_ms * NS_PER_MSEC,
+			ms * NS_PER_MSEC, budget_action, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set budget (%d)\n", err);
+		} else {
+			printf("Okay, task %ld may use %lu ms of CPU every %lu ms\n",
+				task_select, budget_ms, ms);
+		}
+		arm_timer_fd();
+
+	} else if (sscanf(input, "t %ld %lu %lu %d %lu", &task_select, &period_us,
+		&wcet_us, &prio_select, &deadline_us) == 5) {
+		task_params_t params = (task_params_t) {
+			.period_ns   = period_us * NS_PER_USEC,
+			.wcet_ns     = wcet_us * NS_PER_USEC,
+			.deadline_ns = deadline_us * NS_PER_USEC,
+			.prio        = (uint8_t)prio_select
+		};
+
+		// Declare the timing parameters
+		if ((err = set_task_params(task_select, &params, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set parameters (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "+ %lu %lu %d %lu", &period_us, &wcet_us,
+		&prio_select, &deadline_us) == 4) {
+		task_params_t params = (task_params_t) {
+			.period_ns   = period_us * NS_PER_USEC,
+			.wcet_ns     = wcet_us * NS_PER_USEC,
+			.deadline_ns = deadline_us * NS_PER_USEC,
+			.prio        = (uint8_t)prio_select
+		};
+
+		// Admit a new task and fork its worker
+		if ((err = register_task(&params, &task_select, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to register task (%d)\n", err);
+		} else if (spawn_task_worker(task_select) == -1) {
+			deregister_task(task_select, g_task_set);
+		} else {
+			printf("Okay, registered task %ld\n", task_select);
+		}
+
+	} else if (sscanf(input, "- %ld%n", &task_select, &offset) == 1 &&
+		input[offset] == '\0') {
+		task_t task = {.pid = -1};
+
+		// Deregister a task and terminate its workers
+		if (task_select >= 0 && task_select < g_task_set->len) {
+			task = g_task_set->tasks[task_select];
+		}
+		if ((err = deregister_task(task_select, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to deregister task (%d)\n", err);
+		} else {
+			kill_task_workers(&task);
+			printf("Okay, deregistered task %ld\n", task_select);
+		}
+		arm_timer_fd();
+
+	} else if (sscanf(input, "G %ld %c %zu", &group_id, &action, &pool_size)
+		>= 2) {
+		task_group_type_t type = (action == 'r') ? TASK_GROUP_REENTRANT :
+			TASK_GROUP_MUTUALLY_EXCLUSIVE;
+
+		// Configure a callback group
+		if ((err = set_group_type(group_id, type, pool_size, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to configure group (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "g %ld %ld", &task_select, &group_id) == 2) {
+
+		// Move a task into a group (with the workers the group needs)
+		if ((err = set_task_group(task_select, group_id, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set group (%d)\n", err);
+		} else {
+			match_task_pool(task_select);
+		}
+
+	} else if (sscanf(input, "d %ld %d %lu", &task_select, &prio_select, &ms)
+		== 3) {
+		task_callback_attr_t attr = (task_callback_attr_t) {
+			.deadline_ns = ms * NS_PER_MSEC
+		};
+
+		// Push a callback with its own deadline
+		if ((err = enqueue_callback_for_task_attr(task_select, prio_select,
+			&attr, strlen(dummy_data) + 1, dummy_data, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to enqueue task data (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "m %ld %c", &task_select, &action) == 2) {
+		task_miss_action_t miss_action = TASK_MISS_LOG;
+
+		// Choose what happens when the task misses a deadline
+		if (action == 's') {
+			miss_action = TASK_MISS_SKIP_NEXT;
+		} else if (action == 'd') {
+			miss_action = TASK_MISS_DROP_STALE;
+		}
+		if ((err = set_task_miss_action(task_select, miss_action, g_task_set))
+			!= 0) {
+			fprintf(stderr, "Err: Unable to set miss action (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "l %ld %lu", &task_select, &ms) == 2) {
+
+		// Discard callbacks of the task once older than the lifespan
+		if ((err = set_task_lifespan(task_select, ms * NS_PER_MSEC,
+			g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set lifespan (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "q %ld %c", &task_select, &action) == 2) {
+		queue_overflow_t overflow = QUEUE_OVERFLOW_REJECT;
+
+		// Choose what happens when the task queue is full
+		if (action == 'd') {
+			overflow = QUEUE_OVERFLOW_DROP_OLDEST;
+		}
+		if ((err = set_task_overflow(task_select, overflow, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set overflow policy (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "r %ld %c", &task_select, &action) == 2) {
+
+		// Let the task run its queued callbacks back-to-back
+		if ((err = set_task_drain(task_select, action == '1', g_task_set))
+			!= 0) {
+			fprintf(stderr, "Err: Unable to set drain mode (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "e %ld %ld %d", &task_select, &next_task_id,
+		&prio_select) == 3) {
+
+		// Forward the output of a task to the next one in a chain
+		if ((err = set_chain_edge(task_select, next_task_id, prio_select,
+			g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set chain edge (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "C %lu %d%n", &ms, &prio_select, &offset) == 2) {
+		off_t chain[TASK_CHAIN_MAX_LEN], new_chain_id = -1;
+		size_t len = 0;
+		char *p = input + offset, *end = NULL;
+
+		// Read the tasks of the chain
+		for (long t = strtol(p, &end, 10); end != p &&
+			len < TASK_CHAIN_MAX_LEN; t = strtol(p, &end, 10)) {
+			chain[len++] = t;
+			p = end;
+		}
+
+		// Define the chain
+		if ((err = define_chain(chain, len, ms * NS_PER_MSEC, prio_select,
+			&new_chain_id, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to define chain (%d)\n", err);
+		} else {
+			printf("Okay, chain %ld has %zu tasks\n", new_chain_id, len);
+		}
+
+	} else if (sscanf(input, "S %15s %ld %c %d %lu %lu", name, &group_id,
+		&action, &prio_select, &budget_ms, &ms) == 6) {
+
+		// Create a reservation server (f: fixed priority, e: EDF inside)
+		if ((err = make_server(name, group_id, (action == 'e') ?
+			SCHED_POLICY_EDF : SCHED_POLICY_FIXED_PRIO, (uint8_t)prio_select,
+			budget_ms * NS_PER_MSEC, ms * NS_PER_MSEC, &server_id,
+			g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to create server (%d)\n", err);
+		} else {
+			printf("Created server %ld (%s)\n", server_id, name);
+			arm_timer_fd();
+		}
+
+	} else if (strcmp(input, "S") == 0) {
+
+		// Show the reservation servers
+		show_servers(g_task_set);
+
+	} else if (sscanf(input, "j %ld %ld", &task_select, &server_id) == 2) {
+
+		// Move a task into a server
+		if ((err = set_task_server(task_select, server_id, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set server (%d)\n", err);
+		}
+
+	} else if (strcmp(input, "T -") == 0) {
+
+		// Return to dynamic scheduling
+		stop_cyclic_table();
+
+	} else if (sscanf(input, "T %255s", path) == 1) {
+
+		// Follow a schedule table (time-triggered mode)
+		if ((err = start_cyclic_table(path)) != 0) {
+			fprintf(stderr, "Err: Unable to follow table %s (%d)\n", path, err);
+		} else {
+			printf("Following %zu slots per %" PRIu64 " us frame\n",
+				g_cyclic.len, g_cyclic.major_frame_ns / NS_PER_USEC);
+		}
+
+	} else if (sscanf(input, "h %ld", &chain_id) == 1) {
+
+		// Report the end-to-end latency of a chain
+		if (show_chain_latency(chain_id, g_task_set) != 0) {
+			fprintf(stderr, "Err: No chain %ld\n", chain_id);
+		}
+
+	} else if ((matched = sscanf(input, "L %ld %c", &task_select, &action))
+		>= 1) {
+
+		// Report the latency percentiles of a task (and start over if asked)
+		if (task_select < 0 || task_select >= g_task_set->len ||
+			show_task_latency(task_select, g_task_set->stats) != 0) {
+			fprintf(stderr, "Err: No task %ld\n", task_select);
+		} else if (matched == 2 && action == 'r') {
+			reset_task_latency(task_select, g_task_set->stats);
+			printf("Okay, reset the latencies of task %ld\n", task_select);
+		}
+
+	} else if (sscanf(input, "a %ld %lu %d", &task_select, &ms, &prio_select)
+		== 3) {
+
+		// Raise waiting callbacks of the task one priority level per step
+		if ((err = set_task_aging(task_select, ms * NS_PER_MSEC,
+			(uint8_t)prio_select, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set aging (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "O %lu %lf %lf %d", &ms, &high, &low,
+		&prio_select) == 4) {
+
+		// Shed tasks below a criticality when utilization or queue fill
+		// (both in percent) pass the high level, until both are low again
+		if ((err = set_overload_control(ms * NS_PER_MSEC, high / 100.0,
+			low / 100.0, high / 100.0, low / 100.0, (uint8_t)prio_select,
+			g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set overload control (%d)\n", err);
+		}
+
+	} else if (strcmp(input, "O") == 0) {
+
+		// Show the overload controller
+		show_overload(g_task_set);
+
+	} else if (sscanf(input, "M %ld %c %lu %lu %c", &task_select, &action,
+		&budget_ms, &ms, &mode) >= 4) {
+
+		// Set the criticality level and the LO/HI-mode WCETs of a task
+		if ((err = set_task_criticality_level(task_select,
+			(action == 'h') ? TASK_CRIT_HI : TASK_CRIT_LO,
+			budget_ms * NS_PER_MSEC, ms * NS_PER_MSEC,
+			(mode == 't') ? TASK_CRIT_THROTTLE : TASK_CRIT_SUSPEND,
+			g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set criticality level (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "k %ld %d %c", &task_select, &prio_select,
+		&action) >= 2) {
+
+		// Set the criticality of a task (l: keep latest when shed)
+		if ((err = set_task_criticality(task_select, (uint8_t)prio_select,
+			(action == 'l') ? TASK_SHED_KEEP_LATEST : TASK_SHED_DROP,
+			g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to set criticality (%d)\n", err);
+		}
+
+	} else if (sscanf(input, "c %ld", &timer_id) == 1) {
+
+		// Cancel a timer
+		if ((err = cancel_timer_for_task(timer_id, g_task_set)) != 0) {
+			fprintf(stderr, "Err: Unable to cancel timer (%d)\n", err);
+		}
+		arm_timer_fd();
+
+	} else if (sscanf(input, "%ld %d", &task_select, &prio_select) == 2) {
+		prio_select = (prio_select + 0xFF) % 0xFF;
+
+		printf("Okay, pushing cb for task %lu at prio %d\n", 
+			task_select, prio_select);
+
+		if ((err = enqueue_callback_for_task(task_select, prio_select,
+			strlen(dummy_data) + 1, dummy_data, g_task_set)) != 0)
+		{
+			fprintf(stderr, "Err: Unable to enqueue task data (%d)\n",
+				err);
+		}
+	} else {
+		fprintf(stderr, "Err: Unknown command \"%s\"\n", input);
+	}
+
+	unlock_task_set(g_task_set);
+	// **** END critical section ****
+
+	dispatch_highest_prio_task();
+}
+
+// Reads and handles all complete input lines. Returns nonzero on end of input
+static int on_input (void)
+{
+	static char input[MAX_INPUT_LENGTH];
+	static size_t input_len = 0;
+	ssize_t n;
+	char *line, *newline;
+
+	// Discard overlong lines
+	if (input_len == sizeof(input) - 1) {
+		fprintf(stderr, "Err: Command too long\n");
+		input_len = 0;
+	}
+
+	if ((n = read(STDIN_FILENO, input + input_len, 
+		sizeof(input) - 1 - input_len)) <= 0) {
+		return 1;
+	}
+	input_len += n;
+	input[input_len] = '\0';
+
+	// Handle each complete line
+	for (line = input; (newline = strchr(line, '\n')) != NULL;
+		line = newline + 1) {
+		*newline = '\0';
+		if (*line != '\0') {
+			on_command(line);
+		}
+	}
+
+	// Keep any partial line
+	input_len = strlen(line);
+	memmove(input, line, input_len + 1);
+
+	return 0;
+}
+
 /*
  *******************************************************************************
  *                                    Main                                     *
@@ -178,24 +1171,53 @@ void task_routine (off_t task_id)
 int main (int argc, char *argv[])
 {
 	// Configuration
-	const char *shm_map_name  = "ros_exec_shm";
-	const size_t shm_map_size = 8192;
+	const char *shm_map_name  = EXEC_SHM_NAME;
+	const size_t shm_map_size = (1 << 22);
 	pid_t status, pid = -1;
 	int err, n_tasks = -1;
 	size_t task_queue_size = 5;
-	off_t task_stack[MAX_PREEMPTABLE_TASKS];
-	off_t task_stack_index = 0;
+
+	sched_policy_t policy = SCHED_POLICY_FIXED_PRIO;
+	task_lock_type_t lock_type = TASK_LOCK_SEMAPHORE;
 
 	// Check argument count
-	if (argc != 2) {
-		printf("%s [n-forks]\n", argv[0]);
+	if (argc < 2 || argc > 5) {
+		printf("%s [n-forks] [fp|edf|slack] [pi] [perf]\n", argv[0]);
 		return EXIT_FAILURE;
 	}
 
 	// Read number of forks
 	n_tasks = atoi(argv[1]);
 
+	// Read the scheduling policy and the task set lock
+	for (off_t i = 2; i < argc; ++i) {
+		if (strcmp(argv[i], "edf") == 0) {
+			policy = SCHED_POLICY_EDF;
+		} else if (strcmp(argv[i], "slack") == 0) {
+			policy = SCHED_POLICY_CHAIN_SLACK;
+		} else if (strcmp(argv[i], "pi") == 0) {
+			lock_type = TASK_LOCK_PI_MUTEX;
+		} else if (strcmp(argv[i], "perf") == 0) {
+			g_perf_on = true;
+		}
+	}
+
 	printf("Process Count:\t\t\t%d\n", n_tasks);
+	printf("Policy:\t\t\t\t%s\n", sched_policy_name(policy));
+
+	// Workers open their own counters; see which ones this system has
+	if (g_perf_on) {
+		unsigned int opened = perf_open();
+		perf_close();
+		printf("Counters:\t\t\t%s", (opened == 0) ? "<unavailable>" : "");
+		for (off_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+			if (opened & (1u << c)) {
+				printf("%s%s", (opened & ((1u << c) - 1)) ? ", " : "",
+					perf_counter_name(c));
+			}
+		}
+		printf("\n");
+	}
 
 	// Initialize shared memory
 	if ((g_shm = map_shared_memory(
@@ -208,97 +1230,226 @@ int main (int argc, char *argv[])
 
 	printf("Shared Memory:\t\t\tReady\n");
 
-	// Initialize static allocator
-	g_allocator = install_static_allocator(g_shm, shm_map_size);
+	// Hot-path messages are printed by a drainer process, off the workers
+	if (log_open() != 0 || log_attach() != 0 ||
+		(g_log_drainer = log_start_drainer()) == -1) {
+		fprintf(stderr, "Unable to start the logger (printing directly)!\n");
+		log_stop(-1);
+	} else {
+		printf("Logger:\t\t\t\tReady (%s)\n", LOG_SHM_NAME);
+	}
+
+#if defined(ROS_TRACE)
+	// Trace into rings of their own map (dumped with ros_trace_dump)
+	if (trace_open(true) != 0 || trace_attach(-1) != 0) {
+		fprintf(stderr, "Unable to open the trace rings!\n");
+	} else {
+		printf("Trace:\t\t\t\tReady (%s)\n", TRACE_SHM_NAME);
+	}
+#endif
+
+	// Initialize static allocator (after the header monitors attach by)
+	g_shm_header = (exec_shm_header_t *)g_shm;
+	g_allocator = install_static_allocator((uint8_t *)g_shm +
+		SHM_HEADER_SIZE, shm_map_size - SHM_HEADER_SIZE);
+
+	// Serialize the allocator itself. Every caller here also holds the task
+	// set lock, so this lock only nests in it and is never contended
+	if (g_allocator == NULL ||
+		(g_alloc_sem = (sem_t *)static_alloc(g_allocator, sizeof(sem_t)))
+		== NULL || sem_init(g_alloc_sem, 1, 1) == -1) {
+		fprintf(stderr, "Unable to lock the allocator!\n");
+		g_alloc_sem = NULL;
+	}
 
 	printf("Static Allocator:\t\tReady\n");
 
 	// Initialize task set
 	g_task_set = make_task_set(n_tasks, task_queue_size, alloc, release);
 
-	printf("Task Data Set:\t\t\tReady\n");
+	// Enable timers for the task set
+	if (g_task_set == NULL || 
+		init_task_set_timers(MAX_TIMER_COUNT, TIMER_TICK_NS, g_task_set) != 0 ||
+		init_task_set_stats(g_task_set) != 0) {
+		fprintf(stderr, "Unable to create the task set!\n");
+		goto end;
+	}
+	g_task_set->policy = policy;
 
+	// Swap in the robust priority-inheritance mutex before forking
+	if (set_task_set_lock(lock_type, g_task_set) != 0) {
+		fprintf(stderr, "Unable to use a priority-inheritance lock!\n");
+		goto end;
+	}
+
+	// Describe the map to monitors (the magic goes last)
+	*g_shm_header = (exec_shm_header_t) {
+		.executor_pid     = getpid(),
+		.base             = (uintptr_t)g_shm,
+		.size             = shm_map_size,
+		.allocator_offset = (uint8_t *)g_allocator - (uint8_t *)g_shm,
+		.task_set_offset  = (uint8_t *)g_task_set - (uint8_t *)g_shm,
+		.stats_offset     = (uint8_t *)g_task_set->stats - (uint8_t *)g_shm
+	};
+	atomic_thread_fence(memory_order_release);
+	g_shm_header->magic = EXEC_SHM_MAGIC;
+
+	printf("Task Data Set:\t\t\tReady (%s lock)\n",
+		(lock_type == TASK_LOCK_PI_MUTEX) ? "pi-mutex" : "semaphore");
+
+
+	// Worker stops, budget exhaustion and overruns are read from a signal fd
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGCHLD);
+	sigaddset(&signals, TASK_BUDGET_SIGNAL);
+	sigaddset(&signals, TASK_OVERRUN_SIGNAL);
+	if (sigprocmask(SIG_BLOCK, &signals, NULL) == -1 ||
+		(g_signal_fd = signalfd(-1, &signals, SFD_NONBLOCK | SFD_CLOEXEC))
+		== -1) {
+		perror("signalfd");
+		goto end;
+	}
 
 	// Fork some processes
 	for (off_t i = 1; i < n_tasks; ++i) {
-		if ((g_pid = fork()) == 0) {
-			off_t task_id = i - 1;
-
-			// Update self PID
-			g_pid = getpid();
-
-			// Update task information
-			g_task_set->tasks[task_id].pid = g_pid;
-
-			// Update task callback
-			g_task_set->tasks[task_id].cb = task_callback;
-
+		spawn_task_worker(i - 1);
+	}
 
-			// Run the task procedure
-			task_routine(task_id);
+	// Create the timer file-descriptor (no timers are armed yet)
+	if ((g_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)) == -1) {
+		perror("timerfd_create");
+		goto end;
+	}
 
-			// Should never reach here
-			fprintf(stderr, "ILLEGAL POINT!\n");
-			return EXIT_FAILURE;
-		}
+	// Create the schedule table timer (armed in time-triggered mode)
+	if ((g_cyclic_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC)) == -1) {
+		perror("timerfd_create");
+		goto end;
 	}
 
-	// Init network configuration
-	// TODO
+	printf("Timers:\t\t\t\tReady\n");
+
+	// Commands accepted on standard input
+	printf("Commands:\n"
+		"  <task> <prio>                 Push a callback for a task\n"
+		"  p <task> <prio> <period-ms>   Add a periodic timer for a task\n"
+		"  o <task> <prio> <delay-ms>    Add a one-shot timer for a task\n"
+		"  c <timer>                     Cancel a timer\n"
+		"  b <task> <budget-ms> <period-ms> [s]\n"
+		"                                Set a CPU budget (s: suspend when"
+		" exhausted)\n"
+		"  t <task> <period-us> <wcet-us> <prio> <deadline-us>\n"
+		"                                Declare task timing parameters\n"
+		"  + <period-us> <wcet-us> <prio> <deadline-us>\n"
+		"                                Register a task (admission control)\n"
+		"  - <task>                      Deregister a task\n"
+		"  d <task> <prio> <deadline-ms> Push a callback with a deadline\n"
+		"  m <task> <l|s|d>              On a deadline miss: log only, skip"
+		" the next\n"
+		"                                job or drop late queued jobs\n"
+		"  l <task> <lifespan-ms>        Discard callbacks older than this\n"
+		"  q <task> <r|d>                On a full queue: reject new or drop"
+		" oldest\n"
+		"  r <task> <0|1>                Drain queued callbacks without"
+		" suspending\n"
+		"  sub <task> <topic>            Subscribe a task to a topic\n"
+		"  unsub <task> <topic>          Unsubscribe a task from a topic\n"
+		"  pub <topic> <prio>            Publish a callback on a topic\n"
+		"  G <group> <m|r> [pool-size]   Make a callback group mutually"
+		" exclusive\n"
+		"                                or reentrant (with a worker pool)\n"
+		"  g <task> <group>              Move a task into a group (-1: none)\n"
+		"  e <task> <next-task> <prio>   Forward task output along a chain"
+		" (-1: none)\n"
+		"  C <deadline-ms> <prio> <task> <task> ...\n"
+		"                                Define a chain (end-to-end deadline)\n"
+		"  h <chain>                     Show chain end-to-end latencies\n"
+		"  L <task> [r]                  Show task latency percentiles"
+		" (r: reset)\n"
+		"  a <task> <step-ms> <cap>      Age waiting callbacks one priority"
+		" level\n"
+		"                                per step, up to the cap\n"
+		"  O <window-ms> <high-%%> <low-%%> <criticality>\n"
+		"                                Shed less critical tasks in overload\n"
+		"  O                             Show overload state\n"
+		"  k <task> <criticality> [d|l]  Set criticality (shed: drop or keep"
+		" latest)\n"
+		"  S <name> <parent> <f|e> <prio> <budget-ms> <period-ms>\n"
+		"                                Create a reservation server (parent"
+		" -1:\n"
+		"                                top level; f/e: policy inside)\n"
+		"  S                             Show reservation servers\n"
+		"  j <task> <server>             Move a task into a server (-1: none)\n"
+		"  T <table-file>                Release tasks from a schedule table\n"
+		"  T -                           Leave time-triggered mode\n"
+		"  M <task> <l|h> <lo-wcet-ms> <hi-wcet-ms> [s|t]\n"
+		"                                Set criticality level and WCETs"
+		" (LO tasks\n"
+		"                                are suspended or throttled in HI"
+		" mode)\n");
+
+	// Poll on input, the timers and signals
+	struct pollfd fds[4] = {
+		{.fd = STDIN_FILENO, .events = POLLIN, .revents = 0},
+		{.fd = g_timer_fd,   .events = POLLIN, .revents = 0},
+		{.fd = g_signal_fd,  .events = POLLIN, .revents = 0},
+		{.fd = g_cyclic_fd,  .events = POLLIN, .revents = 0}
+	};
+
+	printf("> ");
+	fflush(stdout);
 
 	do {
-		off_t running_task_id = -1;
-		char *dummy_data = "Foo";
-		off_t task_select = -1;
-		int prio_select = -1;
-		printf("Select task to invoke: ");
-		scanf("%ld", &task_select);
-
-		printf("Assign callback priority (0-255): ");
-		scanf("\n%d", &prio_select);
-		prio_select = (prio_select + 0xFF) % 0xFF;
-
-		printf("Okay, pushing cb for task %lu at prio %d\n", 
-			task_select, prio_select);
-
-		// **** Critical section ****
-		sem_wait(&(g_task_set->sem));
-		if ((err = enqueue_callback_for_task(task_select, prio_select,
-			strlen(dummy_data) + 1, dummy_data, g_task_set)) != 0)
-		{
-			fprintf(stderr, "Err: Unable to enqueue task data (%d)\n",
-				err);
+		if ((err = poll(fds, 4, STATS_PUBLISH_MS)) == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("poll");
+			break;
 		}
 
-		// Find highest priority task
-		int task_to_run = get_highest_prio_task_index(g_task_set);
-
-		// Extract running task ID
-		running_task_id = g_task_set->current_running_task_id;
-
-		// Show information
-		// printf("----- Task Set: Global -----\n");
-		// show_task_set(g_task_set);
-		// printf("----------------------------\n");
-		// Print update
-		printf("Suspending %ld, resuming %d\n",
-			running_task_id, task_to_run);
+		// Schedule table releases go first
+		if (fds[3].revents & POLLIN) {
+			on_cyclic();
+		}
 
-		sem_post(&(g_task_set->sem));
-		// **** END critical section ****
+		// Timer expiries
+		if (fds[1].revents & POLLIN) {
+			on_timer();
+		}
 
-		// Signal current running task to stop if exists
-		if (running_task_id != -1) {
-			kill(g_task_set->tasks[running_task_id].pid, SIGSTOP);
-			task_stack[task_stack_index++] = running_task_id;
+		// Stopped workers and exhausted budgets
+		if (fds[2].revents & POLLIN) {
+			on_signal();
 		}
 
-		// Signal task to run to run
-		kill(g_task_set->tasks[task_to_run].pid, SIGCONT);
+		// Commands (stop on end of input)
+		if (fds[0].revents & (POLLIN | POLLHUP)) {
+			if (on_input() != 0) {
+				break;
+			}
+			printf("> ");
+			fflush(stdout);
+		}
 
+		// Refresh the snapshot for monitors (if anything changed)
+		publish_task_set_stats(g_task_set);
 
 	} while (1);
 
+	// Terminate the tasks (including those registered at runtime). Holding
+	// the set lock, no worker is inside the allocator or a queue
+	lock_task_set(g_task_set);
+	for (off_t i = 0; i < g_task_set->len; ++i) {
+		kill_task_workers(g_task_set->tasks + i);
+	}
+	unlock_task_set(g_task_set);
+
+	// Print the remaining log records (log_stop waits for the drainer)
+	log_stop(g_log_drainer);
+	g_log_drainer = -1;
+
 	// Wait for child forks
 	while ((pid = wait(&status)) > 0);
 
@@ -309,6 +1460,16 @@ int main (int argc, char *argv[])
 	}
 
 end:
+	// Stop the logger if setup failed after starting it
+	if (g_log_drainer != -1) {
+		log_stop(g_log_drainer);
+	}
+
+#if defined(ROS_TRACE)
+	// Keep the trace rings around for ros_trace_dump
+	trace_close(false);
+#endif
+
 	// Remove shared memory
 	if (unmap_shared_memory(
 		shm_map_name,
@@ -0,0 +1,176 @@
+#include "ros_histogram.h"
+
+/*
+ *******************************************************************************
+ *                        Internal Function Definitions                        *
+ *******************************************************************************
+*/
+
+
+// Sub-buckets per power of two
+#define SUB_BUCKETS                  (1 << HISTOGRAM_SUB_BITS)
+
+// Returns the bucket of a value. Values under 2 * SUB_BUCKETS have a bucket
+// each; above, bucket (shift * SUB_BUCKETS + top) holds values whose leading
+// HISTOGRAM_SUB_BITS + 1 bits are top (once shifted right by shift)
+static off_t bucket_of (uint64_t value)
+{
+	off_t shift;
+
+	if (value >= ((uint64_t)1 << HISTOGRAM_MAX_BITS)) {
+		return HISTOGRAM_BUCKETS - 1;
+	}
+	if (value < 2 * SUB_BUCKETS) {
+		return (off_t)value;
+	}
+
+	shift = (63 - __builtin_clzll(value)) - HISTOGRAM_SUB_BITS;
+
+	return (shift << HISTOGRAM_SUB_BITS) + (off_t)(value >> shift);
+}
+
+// Returns the largest value held by a bucket
+static uint64_t bucket_highest (off_t bucket)
+{
+	off_t shift;
+	uint64_t top;
+
+	if (bucket < 2 * SUB_BUCKETS) {
+		return (uint64_t)bucket;
+	}
+
+	shift = (bucket >> HISTOGRAM_SUB_BITS) - 1;
+	top = (uint64_t)(bucket - (shift << HISTOGRAM_SUB_BITS));
+
+	return ((top + 1) << shift) - 1;
+}
+
+static uint64_t load (const atomic_uint_least64_t *p)
+{
+	return atomic_load_explicit((atomic_uint_least64_t *)p,
+		memory_order_relaxed);
+}
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+void histogram_record (uint64_t value, histogram_t *histogram_p)
+{
+	uint64_t max;
+
+	if (histogram_p == NULL) {
+		return;
+	}
+
+	atomic_fetch_add_explicit(&(histogram_p->buckets[bucket_of(value)]), 1,
+		memory_order_relaxed);
+	atomic_fetch_add_explicit(&(histogram_p->total), value,
+		memory_order_relaxed);
+	atomic_fetch_add_explicit(&(histogram_p->count), 1, memory_order_relaxed);
+
+	// Raise the maximum unless another process raised it further
+	max = load(&(histogram_p->max));
+	while (value > max && !atomic_compare_exchange_weak_explicit(
+		&(histogram_p->max), &max, value, memory_order_relaxed,
+		memory_order_relaxed));
+}
+
+
+int histogram_percentile (double q, uint64_t *value_p,
+	const histogram_t *histogram_p)
+{
+	uint64_t total = 0, seen = 0, max, counts[HISTOGRAM_BUCKETS];
+
+	// Parameter check
+	if (value_p == NULL || histogram_p == NULL || q < 0.0 || q > 100.0) {
+		return 1;
+	}
+
+	// Rank against the buckets themselves (the count may run ahead)
+	for (off_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+		total += (counts[b] = load(histogram_p->buckets + b));
+	}
+	if (total == 0) {
+		return 2;
+	}
+
+	// First bucket reaching the rank
+	max = load(&(histogram_p->max));
+	*value_p = bucket_highest(HISTOGRAM_BUCKETS - 1);
+	for (off_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+		if (counts[b] > 0 && (seen += counts[b]) >= q / 100.0 * total) {
+			*value_p = bucket_highest(b);
+			break;
+		}
+	}
+	if (*value_p > max && max > 0) {
+		*value_p = max;
+	}
+
+	return 0;
+}
+
+
+void histogram_copy (histogram_t *copy_p, const histogram_t *histogram_p)
+{
+	uint64_t count = 0, n;
+
+	if (copy_p == NULL || histogram_p == NULL) {
+		return;
+	}
+
+	for (off_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+		atomic_init(copy_p->buckets + b, (n = load(histogram_p->buckets + b)));
+		count += n;
+	}
+	atomic_init(&(copy_p->count), count);
+	atomic_init(&(copy_p->total), load(&(histogram_p->total)));
+	atomic_init(&(copy_p->max), load(&(histogram_p->max)));
+}
+
+
+void histogram_reset (histogram_t *histogram_p)
+{
+	if (histogram_p == NULL) {
+		return;
+	}
+
+	for (off_t b = 0; b < HISTOGRAM_BUCKETS; ++b) {
+		atomic_store_explicit(histogram_p->buckets + b, 0,
+			memory_order_relaxed);
+	}
+	atomic_store_explicit(&(histogram_p->count), 0, memory_order_relaxed);
+	atomic_store_explicit(&(histogram_p->total), 0, memory_order_relaxed);
+	atomic_store_explicit(&(histogram_p->max), 0, memory_order_relaxed);
+}
+
+
+void show_histogram (const char *name, const char *unit,
+	const histogram_t *histogram_p)
+{
+	const double qs[] = {50.0, 90.0, 99.0, 99.9};
+	uint64_t count, value;
+
+	if (histogram_p == NULL) {
+		printf("<Null>\n");
+		return;
+	}
+
+	if ((count = load(&(histogram_p->count))) == 0) {
+		printf("  %-10s no samples\n", name);
+		return;
+	}
+
+	printf("  %-10s n %-8" PRIu64 " mean %-8" PRIu64, name, count,
+		load(&(histogram_p->total)) / count);
+	for (off_t i = 0; i < sizeof(qs) / sizeof(qs[0]); ++i) {
+		if (histogram_percentile(qs[i], &value, histogram_p) == 0) {
+			printf(" p%g %-8" PRIu64, qs[i], value);
+		}
+	}
+	printf(" max %" PRIu64 " %s\n", load(&(histogram_p->max)), unit);
+}
@@ -0,0 +1,117 @@
+#if !defined(ROS_HISTOGRAM_H)
+#define ROS_HISTOGRAM_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 14/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Fixed-size log-linear (HDR-style) histograms. Each power of two is split   *
+ *  into linear sub-buckets; counts are atomic so any process may record       *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Sub-buckets per power of two (as bits: buckets are within 1/16 of a value)
+#define HISTOGRAM_SUB_BITS           4
+
+// Values from 2^HISTOGRAM_MAX_BITS on share the last bucket
+#define HISTOGRAM_MAX_BITS           32
+
+// Number of buckets
+#define HISTOGRAM_BUCKETS            ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS \
+                                     + 1) << HISTOGRAM_SUB_BITS)
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Structure: A histogram (all zero when empty, so it may be memset)
+typedef struct {
+	atomic_uint_least64_t count;        // Values recorded
+	atomic_uint_least64_t total;        // Sum of the values
+	atomic_uint_least64_t max;          // Largest value
+	atomic_uint_least64_t buckets[HISTOGRAM_BUCKETS];
+} histogram_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Counts a value (lock-free; safe from any process)
+ * @param value       The value (in the unit of the histogram)
+ * @param histogram_p Pointer to the histogram
+ * @return None
+\*/
+void histogram_record (uint64_t value, histogram_t *histogram_p);
+
+
+/*\
+ * @brief Returns a percentile, as the largest value of the bucket holding
+ *        it (but no more than the largest value recorded)
+ * @param q           The percentile (between 0 and 100)
+ * @param value_p     Where to store the value
+ * @param histogram_p Pointer to the histogram
+ * @return Zero on success; 1 on bad parameters, 2 if there are no values
+\*/
+int histogram_percentile (double q, uint64_t *value_p,
+	const histogram_t *histogram_p);
+
+
+/*\
+ * @brief Copies out a histogram while it may be recorded into. The count
+ *        of the copy always matches its buckets
+ * @param copy_p      Where to copy the histogram to
+ * @param histogram_p Pointer to the histogram
+ * @return None
+\*/
+void histogram_copy (histogram_t *copy_p, const histogram_t *histogram_p);
+
+
+/*\
+ * @brief Empties a histogram. Values recorded meanwhile may be partly kept
+ * @param histogram_p Pointer to the histogram
+ * @return None
+\*/
+void histogram_reset (histogram_t *histogram_p);
+
+
+/*\
+ * @brief Displays the count, mean and percentiles of a histogram
+ * @param name        Label of the histogram
+ * @param unit        Unit of the values
+ * @param histogram_p Pointer to the histogram
+ * @return None
+\*/
+void show_histogram (const char *name, const char *unit,
+	const histogram_t *histogram_p);
+
+
+#endif
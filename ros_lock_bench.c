@@ -0,0 +1,279 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <semaphore.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "ros_static_allocator.h"
+#include "ros_queue.h"
+#include "ros_task_set.h"
+#include "ros_histogram.h"
+#include "ros_time.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Size of the shared memory holding the queues
+#define MEM_SIZE                     (1 << 22)
+
+// Most processes (and tasks per process) measured
+#define MAX_PROCS                    64
+#define MAX_TASKS_PER_PROC           8
+
+// Depth of each task queue
+#define QUEUE_DEPTH                  16
+
+// Default number of enqueue/dequeue pairs per process
+#define DEFAULT_OPS                  200000
+
+// One in this many pairs is timed (timing them all would slow them down)
+#define SAMPLE_EVERY                 64
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Enumeration: What guards a pair
+typedef enum {
+	BENCH_GLOBAL,                       // One lock around bare queue calls
+	BENCH_PER_QUEUE,                    // Only the lock of each queue
+	BENCH_TASK_SET                      // The worker path of the executor
+} bench_mode_t;
+
+/*
+ *******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************
+*/
+
+
+// Shared memory, its allocator (and its lock) and the single lock of the
+// baseline
+uint8_t *g_memory = NULL;
+static_allocator_t *g_allocator = NULL;
+sem_t *g_alloc_sem = NULL;
+sem_t *g_global_sem = NULL;
+
+// Latency of the timed pairs of a round (nanoseconds)
+histogram_t *g_latency = NULL;
+
+// Task queues
+queue_t *g_queues[MAX_PROCS * MAX_TASKS_PER_PROC];
+
+// Task set (one task per queue above, for the executor path)
+task_set_t *g_task_set = NULL;
+
+/*
+ *******************************************************************************
+ *                              Support Functions                              *
+ *******************************************************************************
+*/
+
+
+// Locks the allocator as the executor does (nested in the task set lock)
+uint8_t *alloc (size_t size)
+{
+	uint8_t *ptr = NULL;
+
+	while (sem_wait(g_alloc_sem) == -1 && errno == EINTR);
+	ptr = static_alloc(g_allocator, size);
+	sem_post(g_alloc_sem);
+
+	return ptr;
+}
+
+void release (uint8_t *ptr)
+{
+	while (sem_wait(g_alloc_sem) == -1 && errno == EINTR);
+	static_free(g_allocator, ptr);
+	sem_post(g_alloc_sem);
+}
+
+// Passes one callback through a task the way the executor and a worker do:
+// enqueue, then dequeue and begin, then complete and free, each step in its
+// own critical section of the task set
+static void task_set_pair (off_t task_id, size_t i)
+{
+	task_callback_t *callback_p = NULL;
+
+	lock_task_set(g_task_set);
+	enqueue_callback_for_task(task_id, 0, sizeof(i), &i, g_task_set);
+	unlock_task_set(g_task_set);
+
+	lock_task_set(g_task_set);
+	if (dequeue_callback_for_task(task_id, &callback_p, g_task_set) != 0) {
+		unlock_task_set(g_task_set);
+		return;
+	}
+	begin_task_callback(task_id, callback_p, g_task_set);
+	unlock_task_set(g_task_set);
+
+	lock_task_set(g_task_set);
+	complete_task_callback(task_id, callback_p, g_task_set);
+	free_task_callback(callback_p, g_task_set);
+	unlock_task_set(g_task_set);
+}
+
+// Moves elements through the tasks of one process, as workers do
+static void worker (off_t proc, size_t tasks, size_t ops, bench_mode_t mode)
+{
+	void *elem_p = NULL;
+	uint64_t start_ns = 0;
+
+	for (size_t i = 0; i < ops; ++i) {
+		off_t task_id = proc * tasks + i % tasks;
+		queue_t *queue_p = g_queues[task_id];
+
+		if (i % SAMPLE_EVERY == 0) {
+			start_ns = time_now_ns();
+		}
+		if (mode == BENCH_TASK_SET) {
+			task_set_pair(task_id, i);
+		} else {
+			if (mode == BENCH_GLOBAL) {
+				while (sem_wait(g_global_sem) == -1 && errno == EINTR);
+			}
+			enqueue((void *)(uintptr_t)(i + 1), queue_p);
+			dequeue(&elem_p, queue_p);
+			if (mode == BENCH_GLOBAL) {
+				sem_post(g_global_sem);
+			}
+		}
+		if (i % SAMPLE_EVERY == 0) {
+			histogram_record(time_now_ns() - start_ns, g_latency);
+		}
+	}
+
+	_exit(EXIT_SUCCESS);
+}
+
+// Runs a round with the given number of processes. Returns the throughput,
+// and the 99th percentile latency of a pair through p99_ns_p
+static double run_round (size_t procs, size_t tasks, size_t ops,
+	bench_mode_t mode, uint64_t *p99_ns_p)
+{
+	uint64_t start_ns, elapsed_ns;
+	int status;
+
+	histogram_reset(g_latency);
+	start_ns = time_now_ns();
+
+	for (off_t p = 0; p < procs; ++p) {
+		if (fork() == 0) {
+			worker(p, tasks, ops, mode);
+		}
+	}
+	while (wait(&status) > 0);
+
+	elapsed_ns = time_now_ns() - start_ns;
+
+	if (histogram_percentile(99.0, p99_ns_p, g_latency) != 0) {
+		*p99_ns_p = 0;
+	}
+
+	return (double)(procs * ops) / elapsed_ns * 1e3;
+}
+
+/*
+ *******************************************************************************
+ *                                    Main                                     *
+ *******************************************************************************
+*/
+
+
+int main (int argc, char *argv[])
+{
+	size_t max_procs = sysconf(_SC_NPROCESSORS_ONLN) * 2;
+	size_t ops = DEFAULT_OPS;
+
+	// Check arguments
+	if (argc > 3) {
+		printf("%s [max-procs] [ops-per-proc]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (argc >= 2) {
+		max_procs = strtoul(argv[1], NULL, 10);
+	}
+	if (argc == 3) {
+		ops = strtoul(argv[2], NULL, 10);
+	}
+	if (max_procs == 0 || max_procs > MAX_PROCS || ops == 0) {
+		fprintf(stderr, "Between 1 and %d processes, and some operations\n",
+			MAX_PROCS);
+		return EXIT_FAILURE;
+	}
+
+	// Place the queues and the baseline lock in shared memory
+	if ((g_memory = mmap(NULL, MEM_SIZE, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED) {
+		perror("mmap");
+		return EXIT_FAILURE;
+	}
+	g_allocator = install_static_allocator(g_memory, MEM_SIZE);
+	if (g_allocator == NULL || (g_alloc_sem = (sem_t *)static_alloc(
+		g_allocator, sizeof(sem_t))) == NULL ||
+		sem_init(g_alloc_sem, 1, 1) == -1) {
+		fprintf(stderr, "Unable to lock the allocator\n");
+		return EXIT_FAILURE;
+	}
+	if ((g_global_sem = (sem_t *)alloc(sizeof(sem_t))) == NULL ||
+		sem_init(g_global_sem, 1, 1) == -1) {
+		fprintf(stderr, "Unable to create the global lock\n");
+		return EXIT_FAILURE;
+	}
+	if ((g_latency = (histogram_t *)alloc(sizeof(histogram_t))) == NULL) {
+		fprintf(stderr, "Unable to create the latency histogram\n");
+		return EXIT_FAILURE;
+	}
+	memset(g_latency, 0, sizeof(histogram_t));
+	for (off_t i = 0; i < MAX_PROCS * MAX_TASKS_PER_PROC; ++i) {
+		if ((g_queues[i] = make_queue(QUEUE_DEPTH, alloc, release)) == NULL) {
+			fprintf(stderr, "Unable to create queue %ld\n", i);
+			return EXIT_FAILURE;
+		}
+	}
+	if ((g_task_set = make_task_set(MAX_PROCS * MAX_TASKS_PER_PROC,
+		QUEUE_DEPTH, alloc, release)) == NULL) {
+		fprintf(stderr, "Unable to create the task set\n");
+		return EXIT_FAILURE;
+	}
+
+	printf("%zu online CPUs, %zu enqueue/dequeue pairs per process\n",
+		(size_t)sysconf(_SC_NPROCESSORS_ONLN), ops);
+	printf("%6s %6s %15s %15s %15s %12s %12s %12s\n", "procs", "tasks",
+		"global Mop/s", "queue Mop/s", "task set Mop/s", "global p99",
+		"queue p99", "task set p99");
+
+	// Scale processes (cores) and the tasks each process serves
+	for (size_t procs = 1; procs <= max_procs; procs *= 2) {
+		for (size_t tasks = 1; tasks <= MAX_TASKS_PER_PROC; tasks *= 8) {
+			uint64_t global_p99, split_p99, set_p99;
+			double global = run_round(procs, tasks, ops, BENCH_GLOBAL,
+				&global_p99);
+			double split = run_round(procs, tasks, ops, BENCH_PER_QUEUE,
+				&split_p99);
+			double set = run_round(procs, tasks, ops, BENCH_TASK_SET,
+				&set_p99);
+			printf("%6zu %6zu %15.2f %15.2f %15.2f %12" PRIu64 " %12" PRIu64
+				" %12" PRIu64 "\n", procs, procs * tasks, global, split, set,
+				global_p99, split_p99, set_p99);
+		}
+	}
+
+	munmap(g_memory, MEM_SIZE);
+
+	return EXIT_SUCCESS;
+}
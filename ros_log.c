@@ -0,0 +1,239 @@
+#include "ros_log.h"
+
+/*
+ *******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************
+*/
+
+
+// Message of each format ID (integer conversions only)
+static const char *g_log_formats[LOG_FORMAT_COUNT] = {
+	[LOG_ALLOC_FREED]    = "[Adding %" PRId64 " bytes]\n",
+	[LOG_TASK_SKIPPED]   = "Task %" PRId64 " has no data -> skipping!\n",
+	[LOG_TASK_DEFAULT]   = "Setting Task %" PRId64 " as default!\n",
+	[LOG_TASK_PREFERRED] = "Task %" PRId64 " has a higher prio for its next "
+	                       "data element than %" PRId64 "\n",
+	[LOG_DISPATCH]       = "Suspending %" PRId64 ", resuming %" PRId64 "\n",
+	[LOG_WORKER_AWOKEN]  = "[%" PRId64 "] Awoken!\n",
+	[LOG_WORKER_SUM]     = "[%" PRId64 "] Sum = %" PRId64 "\n",
+	[LOG_WORKER_DONE]    = "[%" PRId64 "] Execution complete!\n",
+	[LOG_HI_MODE]        = "Task %" PRId64 " overran its LO-mode WCET: "
+	                       "entering HI mode\n",
+	[LOG_LO_MODE]        = "Idle: returning to LO mode\n"
+};
+
+// The mapped rings, and the ring of this process (NULL until attached)
+static log_buffer_t *g_log_buffer = NULL;
+static log_ring_t *g_log_ring = NULL;
+
+/*
+ *******************************************************************************
+ *                        Internal Function Definitions                        *
+ *******************************************************************************
+*/
+
+
+static void print_record (const log_record_t *record_p)
+{
+	if (record_p->format >= LOG_FORMAT_COUNT) {
+		return;
+	}
+
+	printf(g_log_formats[record_p->format], record_p->args[0],
+		record_p->args[1], record_p->args[2], record_p->args[3]);
+}
+
+static int compare_records (const void *a, const void *b)
+{
+	const log_record_t *x = (const log_record_t *)a;
+	const log_record_t *y = (const log_record_t *)b;
+
+	return (x->ts_ns > y->ts_ns) - (x->ts_ns < y->ts_ns);
+}
+
+// Prints everything written so far, merged across processes by time.
+// Returns the number of records printed
+static size_t drain_rings (log_record_t *batch)
+{
+	size_t n = 0;
+
+	for (off_t i = 0; i < LOG_MAX_RINGS; ++i) {
+		log_ring_t *ring_p = g_log_buffer->rings + i;
+		uint64_t tail, head, dropped;
+
+		if (atomic_load(&(ring_p->owner)) == 0) {
+			continue;
+		}
+
+		// Copy the written records, then hand the slots back
+		tail = atomic_load_explicit(&(ring_p->tail), memory_order_relaxed);
+		head = atomic_load_explicit(&(ring_p->head), memory_order_acquire);
+		for (; tail < head; ++tail) {
+			batch[n++] = ring_p->records[tail & (LOG_RING_LEN - 1)];
+		}
+		atomic_store_explicit(&(ring_p->tail), tail, memory_order_release);
+
+		if ((dropped = atomic_exchange(&(ring_p->dropped), 0)) > 0) {
+			printf("[log] %" PRIu64 " records of %d dropped\n", dropped,
+				atomic_load(&(ring_p->owner)));
+		}
+	}
+
+	qsort(batch, n, sizeof(log_record_t), compare_records);
+	for (off_t i = 0; i < n; ++i) {
+		print_record(batch + i);
+	}
+	fflush(stdout);
+
+	return n;
+}
+
+// Body of the drainer process
+static void drainer_routine (pid_t parent)
+{
+	struct timespec interval = time_ns_to_timespec(LOG_DRAIN_INTERVAL_MS *
+		NS_PER_MSEC);
+	log_record_t *batch = NULL;
+
+	if ((batch = malloc(LOG_MAX_RINGS * LOG_RING_LEN *
+		sizeof(log_record_t))) == NULL) {
+		perror("malloc");
+		exit(EXIT_FAILURE);
+	}
+
+	// Run until told to stop (or orphaned), then empty the rings
+	while (!atomic_load(&(g_log_buffer->stop)) && getppid() == parent) {
+		nanosleep(&interval, NULL);
+		drain_rings(batch);
+	}
+	while (drain_rings(batch) > 0);
+
+	free(batch);
+	exit(EXIT_SUCCESS);
+}
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+int log_open (void)
+{
+	if ((g_log_buffer = (log_buffer_t *)map_shared_memory(LOG_SHM_NAME,
+		sizeof(log_buffer_t), true)) == NULL) {
+		return 1;
+	}
+	memset(g_log_buffer, 0, sizeof(log_buffer_t));
+
+	return 0;
+}
+
+
+int log_attach (void)
+{
+	int pid = getpid(), expected;
+
+	// Anything inherited belongs to the parent
+	g_log_ring = NULL;
+
+	if (g_log_buffer == NULL) {
+		return 1;
+	}
+
+	// Take a free ring, or an emptied one whose writer has exited
+	for (off_t i = 0; i < LOG_MAX_RINGS; ++i) {
+		log_ring_t *ring_p = g_log_buffer->rings + i;
+
+		expected = atomic_load(&(ring_p->owner));
+		if (expected != 0 && ((kill(expected, 0) == 0 || errno != ESRCH) ||
+			atomic_load(&(ring_p->tail)) != atomic_load(&(ring_p->head)))) {
+			continue;
+		}
+		if (atomic_compare_exchange_strong(&(ring_p->owner), &expected, pid)) {
+			g_log_ring = ring_p;
+			return 0;
+		}
+	}
+
+	fprintf(stderr, "%s:%d: No log ring left for process %d\n",
+		__FILE__, __LINE__, pid);
+
+	return 2;
+}
+
+
+pid_t log_start_drainer (void)
+{
+	pid_t parent = getpid(), pid;
+
+	if (g_log_buffer == NULL) {
+		return -1;
+	}
+
+	// Don't duplicate buffered output in the drainer
+	fflush(stdout);
+
+	if ((pid = fork()) == 0) {
+		g_log_ring = NULL;
+		drainer_routine(parent);
+	} else if (pid == -1) {
+		perror("fork");
+	}
+
+	return pid;
+}
+
+
+void log_write (log_format_t format, const int64_t args[LOG_MAX_ARGS])
+{
+	log_ring_t *ring_p = g_log_ring;
+	uint64_t head;
+
+	// Without a ring, print right away
+	if (ring_p == NULL) {
+		log_record_t record = {.format = format};
+		memcpy(record.args, args, sizeof(record.args));
+		print_record(&record);
+		return;
+	}
+
+	// Single writer: fill the slot if free, then publish it
+	head = atomic_load_explicit(&(ring_p->head), memory_order_relaxed);
+	if (head - atomic_load_explicit(&(ring_p->tail), memory_order_acquire)
+		>= LOG_RING_LEN) {
+		atomic_fetch_add_explicit(&(ring_p->dropped), 1, memory_order_relaxed);
+		return;
+	}
+
+	log_record_t *record_p = ring_p->records + (head & (LOG_RING_LEN - 1));
+	record_p->ts_ns  = time_now_ns();
+	record_p->format = (uint16_t)format;
+	memcpy(record_p->args, args, sizeof(record_p->args));
+	atomic_store_explicit(&(ring_p->head), head + 1, memory_order_release);
+}
+
+
+int log_stop (pid_t drainer_pid)
+{
+	if (g_log_buffer == NULL) {
+		return 1;
+	}
+
+	// Let the drainer empty the rings before removing them
+	atomic_store(&(g_log_buffer->stop), true);
+	if (drainer_pid > 0 && waitpid(drainer_pid, NULL, 0) == -1) {
+		perror("waitpid");
+	}
+
+	if (unmap_shared_memory(LOG_SHM_NAME, g_log_buffer, sizeof(log_buffer_t),
+		true) != 0) {
+		return 1;
+	}
+	g_log_buffer = NULL;
+	g_log_ring = NULL;
+
+	return 0;
+}
@@ -0,0 +1,156 @@
+#if !defined(ROS_LOG_H)
+#define ROS_LOG_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 12/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Asynchronous binary logger. Call sites append a format ID and integer      *
+ *  arguments to a ring of their process; a drainer process formats them       *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "ros_exec_shm.h"
+#include "ros_time.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Name of the shared memory map holding the rings
+#define LOG_SHM_NAME                 "ros_exec_log"
+
+// Number of rings (processes logging at once)
+#define LOG_MAX_RINGS                64
+
+// Records per ring (a power of two; records are dropped when full)
+#define LOG_RING_LEN                 1024
+
+// Arguments per record
+#define LOG_MAX_ARGS                 4
+
+// Interval at which the drainer empties the rings
+#define LOG_DRAIN_INTERVAL_MS        10
+
+// Logs a message by format ID, with up to LOG_MAX_ARGS integer arguments
+#define LOG(format, ...)             log_write((format), \
+                                     (int64_t [LOG_MAX_ARGS]){__VA_ARGS__})
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Enumeration: Messages that may be logged (see the table in ros_log.c)
+typedef enum {
+	LOG_ALLOC_FREED = 0,                // [bytes]
+	LOG_TASK_SKIPPED,                   // [task]
+	LOG_TASK_DEFAULT,                   // [task]
+	LOG_TASK_PREFERRED,                 // [task, previous best]
+	LOG_DISPATCH,                       // [suspended task, resumed task]
+	LOG_WORKER_AWOKEN,                  // [pid]
+	LOG_WORKER_SUM,                     // [pid, sum]
+	LOG_WORKER_DONE,                    // [pid]
+	LOG_HI_MODE,                        // [task]
+	LOG_LO_MODE,                        // [0]
+	LOG_FORMAT_COUNT
+} log_format_t;
+
+
+// Structure: A log record
+typedef struct {
+	uint64_t ts_ns;                     // CLOCK_MONOTONIC timestamp
+	int64_t args[LOG_MAX_ARGS];         // Arguments of the format
+	uint16_t format;                    // Format ID
+} log_record_t;
+
+
+// Structure: Ring of the records of a single process
+typedef struct {
+	atomic_int owner;                   // PID of the writer (0 if free)
+	atomic_uint_least64_t head;         // Records written (by the owner)
+	atomic_uint_least64_t tail;         // Records drained (by the drainer)
+	atomic_uint_least64_t dropped;      // Records lost to a full ring
+	log_record_t records[LOG_RING_LEN];
+} log_ring_t;
+
+
+// Structure: All rings
+typedef struct {
+	atomic_bool stop;                   // Tells the drainer to finish
+	log_ring_t rings[LOG_MAX_RINGS];
+} log_buffer_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Creates (and clears) the log rings. Forked children inherit them
+ * @return Zero on success; 1 if the map is unavailable
+\*/
+int log_open (void);
+
+
+/*\
+ * @brief Claims a ring for the calling process. Must be called again in
+ *        the child after a fork (until then it logs synchronously)
+ * @return Zero on success; 1 if not open, 2 if all rings are taken
+\*/
+int log_attach (void);
+
+
+/*\
+ * @brief Forks the drainer, which formats records onto standard output
+ * @return PID of the drainer; -1 on error
+\*/
+pid_t log_start_drainer (void);
+
+
+/*\
+ * @brief Appends a record to the ring of the calling process, never
+ *        blocking (a full ring drops it). Processes without a ring print
+ *        the message directly. Use LOG() instead
+ * @param format The format ID
+ * @param args   The arguments of the format
+ * @return None
+\*/
+void log_write (log_format_t format, const int64_t args[LOG_MAX_ARGS]);
+
+
+/*\
+ * @brief Has the drainer empty the rings one last time and exit, then
+ *        removes the rings
+ * @param drainer_pid PID returned by log_start_drainer
+ * @return Zero on success; 1 on error
+\*/
+int log_stop (pid_t drainer_pid);
+
+
+#endif
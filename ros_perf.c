@@ -0,0 +1,136 @@
+#define _DEFAULT_SOURCE
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "ros_perf.h"
+
+/*
+ *******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************
+*/
+
+
+// Counter file-descriptors of this process (-1 if not open)
+static int g_perf_fds[PERF_COUNTER_COUNT] = {-1, -1, -1, -1};
+
+/*
+ *******************************************************************************
+ *                        Internal Function Definitions                        *
+ *******************************************************************************
+*/
+
+
+// Opens one counter of the calling process on any CPU
+static int open_counter (uint32_t type, uint64_t config, bool user_only)
+{
+	struct perf_event_attr attr;
+
+	memset(&attr, 0, sizeof(attr));
+	attr.size           = sizeof(attr);
+	attr.type           = type;
+	attr.config         = config;
+	attr.exclude_kernel = user_only;
+	attr.exclude_hv     = 1;
+	attr.read_format    = PERF_FORMAT_TOTAL_TIME_ENABLED |
+	                      PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1,
+		PERF_FLAG_FD_CLOEXEC);
+}
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+unsigned int perf_open (void)
+{
+	unsigned int opened = 0;
+
+	// Hardware counters are taken in user space only (as unprivileged
+	// users may); switches happen in the kernel so they count there
+	const struct {
+		uint32_t type;
+		uint64_t config;
+		bool user_only;
+	} counters[PERF_COUNTER_COUNT] = {
+		[PERF_CYCLES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, true},
+		[PERF_INSTRUCTIONS] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS,
+			true},
+		[PERF_CACHE_MISSES] = {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES,
+			true},
+		[PERF_CONTEXT_SWITCHES] = {PERF_TYPE_SOFTWARE,
+			PERF_COUNT_SW_CONTEXT_SWITCHES, false}
+	};
+
+	perf_close();
+
+	for (off_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+		if ((g_perf_fds[c] = open_counter(counters[c].type,
+			counters[c].config, counters[c].user_only)) != -1) {
+			opened |= (1u << c);
+		}
+	}
+
+	return opened;
+}
+
+
+void perf_read (perf_sample_t *sample_p)
+{
+	uint64_t values[3];
+
+	for (off_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+		sample_p->counts[c] = 0;
+
+		if (g_perf_fds[c] == -1 ||
+			read(g_perf_fds[c], values, sizeof(values)) != sizeof(values)) {
+			continue;
+		}
+
+		// Values are [count, time enabled, time running]
+		if (values[2] > 0 && values[2] < values[1]) {
+			values[0] = (uint64_t)((double)values[0] * values[1] / values[2]);
+		}
+		sample_p->counts[c] = values[0];
+	}
+}
+
+
+void perf_delta (perf_sample_t *delta_p, const perf_sample_t *before_p,
+	const perf_sample_t *after_p)
+{
+	for (off_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+		delta_p->counts[c] = (after_p->counts[c] > before_p->counts[c]) ?
+			after_p->counts[c] - before_p->counts[c] : 0;
+	}
+}
+
+
+const char *perf_counter_name (perf_counter_t counter)
+{
+	static const char *names[PERF_COUNTER_COUNT] = {
+		[PERF_CYCLES]           = "cycles",
+		[PERF_INSTRUCTIONS]     = "instructions",
+		[PERF_CACHE_MISSES]     = "cache-misses",
+		[PERF_CONTEXT_SWITCHES] = "context-switches"
+	};
+
+	return (counter < PERF_COUNTER_COUNT) ? names[counter] : "unknown";
+}
+
+
+void perf_close (void)
+{
+	for (off_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+		if (g_perf_fds[c] != -1) {
+			close(g_perf_fds[c]);
+			g_perf_fds[c] = -1;
+		}
+	}
+}
@@ -0,0 +1,99 @@
+#if !defined(ROS_PERF_H)
+#define ROS_PERF_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 13/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Performance counters of the calling process (perf_event_open). Counters    *
+ *  the kernel or hardware doesn't offer simply read as zero                   *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Enumeration: Counters of a process
+typedef enum {
+	PERF_CYCLES = 0,                    // CPU cycles (user space)
+	PERF_INSTRUCTIONS,                  // Instructions retired (user space)
+	PERF_CACHE_MISSES,                  // Last-level cache misses
+	PERF_CONTEXT_SWITCHES,              // Times the process was switched out
+	PERF_COUNTER_COUNT
+} perf_counter_t;
+
+
+// Structure: Counter values at some point
+typedef struct {
+	uint64_t counts[PERF_COUNTER_COUNT];
+} perf_sample_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Opens the counters of the calling process. Counters aren't
+ *        inherited, so forked children must open their own
+ * @return Bitmask of the counters opened (bit c: perf_counter_t c)
+\*/
+unsigned int perf_open (void);
+
+
+/*\
+ * @brief Reads the counters of the calling process (scaled up if the
+ *        kernel multiplexed them). Unopened counters read as zero
+ * @param sample_p Where to store the values
+ * @return None
+\*/
+void perf_read (perf_sample_t *sample_p);
+
+
+/*\
+ * @brief Stores the change of the counters since an earlier sample
+ * @param delta_p  Where to store the difference
+ * @param before_p The earlier sample
+ * @param after_p  The later sample
+ * @return None
+\*/
+void perf_delta (perf_sample_t *delta_p, const perf_sample_t *before_p,
+	const perf_sample_t *after_p);
+
+
+/*\
+ * @brief Returns the name of a counter
+ * @param counter The counter
+ * @return Name of the counter
+\*/
+const char *perf_counter_name (perf_counter_t counter);
+
+
+/*\
+ * @brief Closes the counters of the calling process
+ * @return None
+\*/
+void perf_close (void);
+
+
+#endif
@@ -1,6 +1,88 @@
 #include "ros_queue.h"
 
 
+// Takes the lock of the queue (retrying if interrupted)
+static void queue_lock (queue_t *queue_p)
+{
+	while (sem_wait(&(queue_p->lock)) == -1 && errno == EINTR);
+}
+
+// Releases the lock of the queue
+static void queue_unlock (queue_t *queue_p)
+{
+	sem_post(&(queue_p->lock));
+}
+
+// Inserts an element with the lock held
+static int enqueue_locked (void *elem_p, void **evicted_p_p, queue_t *queue_p)
+{
+	// Capacity check
+	if (queue_p->len >= queue_p->cap) {
+		switch (queue_p->overflow) {
+
+			// Overwrite the oldest element in the ring (it sits at ptr)
+			case QUEUE_OVERFLOW_DROP_OLDEST:
+				if (queue_p->cap == 0) {
+					queue_p->rejected++;
+					return 2;
+				}
+				if (evicted_p_p != NULL) {
+					*evicted_p_p = queue_p->array[queue_p->ptr];
+				}
+				queue_p->array[queue_p->ptr] = elem_p;
+				queue_p->ptr = (queue_p->ptr + 1) % queue_p->cap;
+				queue_p->evicted++;
+				return 0;
+
+			case QUEUE_OVERFLOW_REJECT:
+			default:
+				queue_p->rejected++;
+				return 2;
+		}
+	}
+
+	// Insert element
+	queue_p->array[queue_p->ptr] = elem_p;
+
+	// Update pointer
+	queue_p->ptr = (queue_p->ptr + 1) % queue_p->cap;
+
+	// Update length (and count the element for waiting consumers)
+	queue_p->len++;
+	sem_post(&(queue_p->items));
+
+	return 0;
+}
+
+// Copies out the oldest element with the lock held (removing it if asked).
+// A claimed removal already took its count in queue_wait_for_data
+static int take_locked (void **elem_p_p, bool remove, bool claimed,
+	queue_t *queue_p)
+{
+	// Capacity check
+	if (queue_p->len <= 0) {
+		return 2;
+	}
+
+	// Compute dequeue index
+	int i = queue_p->ptr, len = queue_p->len, cap = queue_p->cap;
+	int index = ((i - len) % cap + cap) % cap;
+
+	// Copy element out
+	*elem_p_p = queue_p->array[index];
+
+	// Update length
+	if (remove) {
+		queue_p->len--;
+		if (!claimed) {
+			sem_trywait(&(queue_p->items));
+		}
+	}
+
+	return 0;
+}
+
+
 queue_t *make_queue (size_t capacity, uint8_t *(*alloc)(size_t), 
 	void (*release)(uint8_t *))
 {
@@ -28,84 +110,130 @@ queue_t *make_queue (size_t capacity, uint8_t *(*alloc)(size_t),
 		.ptr       = 0,
 		.len       = 0,
 		.cap       = capacity,
+		.overflow  = QUEUE_OVERFLOW_REJECT,
+		.rejected  = 0,
+		.evicted   = 0,
 		.alloc     = alloc,
 		.release   = release
 	};
 
+	// Count elements for blocked consumers
+	if (sem_init(&(queue_p->lock), 1, 1) == -1 ||
+		sem_init(&(queue_p->items), 1, 0) == -1) {
+		perror("sem_init");
+	}
+
 	return queue_p;
 }
 
 
+int set_queue_overflow (queue_overflow_t overflow, queue_t *queue_p)
+{
+	// Parameter check
+	if (queue_p == NULL) {
+		return 1;
+	}
+
+	queue_p->overflow = overflow;
+
+	return 0;
+}
+
+
 int enqueue (void *elem_p, queue_t *queue_p)
 {
+	return enqueue_evict(elem_p, NULL, queue_p);
+}
+
+
+int enqueue_evict (void *elem_p, void **evicted_p_p, queue_t *queue_p)
+{
+	int err;
 
 	// Parameter check
 	if (queue_p == NULL || elem_p == NULL) {
 		return 1;
 	}
 
-	// Capacity check
-	if (queue_p->len >= queue_p->cap) {
-		return 2;
+	if (evicted_p_p != NULL) {
+		*evicted_p_p = NULL;
 	}
 
-	// Insert element
-	queue_p->array[queue_p->ptr] = elem_p;
-
-	// Update pointer
-	queue_p->ptr = (queue_p->ptr + 1) % queue_p->cap;
+	queue_lock(queue_p);
+	err = enqueue_locked(elem_p, evicted_p_p, queue_p);
+	queue_unlock(queue_p);
 
-	// Update length
-	queue_p->len++;
-
-	return 0;
+	return err;
 }
 
+
 int peek (void **elem_p_p, queue_t *queue_p)
 {
+	int err;
+
 	// Parameter check
 	if (queue_p == NULL || elem_p_p == NULL) {
 		return 1;
 	}
 
-	// Capacity check
-	if (queue_p->len <= 0) {
-		return 2;
-	}
-
-	// Compute dequeue index
-	int i = queue_p->ptr, len = queue_p->len, cap = queue_p->cap;
-	int index = ((i - len) % cap + cap) % cap;
+	queue_lock(queue_p);
+	err = take_locked(elem_p_p, false, false, queue_p);
+	queue_unlock(queue_p);
 
-	// Assign element pointer
-	*elem_p_p = queue_p->array[index];
-
-	return 0;
+	return err;
 }
 
 
 int dequeue (void **elem_p_p, queue_t *queue_p)
 {
+	int err;
 
 	// Parameter check
 	if (queue_p == NULL || elem_p_p == NULL) {
 		return 1;
 	}
 
-	// Capacity check
-	if (queue_p->len <= 0) {
-		return 2;
+	queue_lock(queue_p);
+	err = take_locked(elem_p_p, true, false, queue_p);
+	queue_unlock(queue_p);
+
+	return err;
+}
+
+
+int dequeue_claimed (void **elem_p_p, queue_t *queue_p)
+{
+	int err;
+
+	// Parameter check
+	if (queue_p == NULL || elem_p_p == NULL) {
+		return 1;
 	}
 
-	// Compute dequeue index
-	int i = queue_p->ptr, len = queue_p->len, cap = queue_p->cap;
-	int index = ((i - len) % cap + cap) % cap;
+	// The claim is spent even if another consumer took the element first
+	// (it then only made up for that consumer finding no count to take)
+	queue_lock(queue_p);
+	err = take_locked(elem_p_p, true, true, queue_p);
+	queue_unlock(queue_p);
 
-	// Copy element out
-	*elem_p_p = queue_p->array[index];
+	return err;
+}
 
-	// Update length
-	queue_p->len--;
+
+int queue_wait_for_data (queue_t *queue_p)
+{
+	// Parameter check
+	if (queue_p == NULL) {
+		return 1;
+	}
+
+	// Wait for an element, keeping its count (see dequeue_claimed): handing
+	// it back would race with the count taken by other consumers
+	while (sem_wait(&(queue_p->items)) == -1) {
+		if (errno != EINTR) {
+			return 1;
+		}
+	}
 
 	return 0;
 }
@@ -118,6 +246,10 @@ int destroy_queue (queue_t *queue_p)
 		return 1;
 	}
 
+	// Destroy the lock and element count
+	sem_destroy(&(queue_p->lock));
+	sem_destroy(&(queue_p->items));
+
 	// Free the array
 	if (queue_p->array != NULL) {
 		queue_p->release((uint8_t *)queue_p->array);
@@ -140,8 +272,8 @@ void show_queue (queue_t *queue_p, void (*show)(void * const elem))
 	}
 
 	// Compute head of queue
-	off_t head = 
-	(off_t)(((int)queue_p->ptr - (int)queue_p->len) % (int)queue_p->cap);
+	int i = queue_p->ptr, len = queue_p->len, cap = queue_p->cap;
+	off_t head = (off_t)(((i - len) % cap + cap) % cap);
 
 	// Print queue contents
 	for (off_t i = 0; i < queue_p->len; ++i) {
@@ -20,6 +20,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <semaphore.h>
 #include <sys/types.h>
 
 /*
@@ -29,6 +32,13 @@
 */
 
 
+// Enumeration: What happens when enqueuing into a full queue
+typedef enum {
+	QUEUE_OVERFLOW_REJECT = 0,          // The new element is refused
+	QUEUE_OVERFLOW_DROP_OLDEST          // The oldest element is evicted
+} queue_overflow_t;
+
+
 // Structure: Queue data structure
 typedef struct {
 	void **array;                       // Array of queue elements
@@ -36,6 +46,13 @@ typedef struct {
 	size_t len;                         // Queue length
 	size_t cap;                         // Total capacity
 
+	queue_overflow_t overflow;          // Policy when full
+	sem_t lock;                         // Guards the ring (inter-process);
+	                                    // nested in the task set lock there
+	sem_t items;                        // Queued elements (inter-process)
+	uint64_t rejected;                  // Elements refused when full
+	uint64_t evicted;                   // Elements evicted when full
+
 	uint8_t *(*alloc)(size_t size);     // Allocator for more memory
 	void (*release)(uint8_t *mem_ptr);  // Deallocator for memory
 } queue_t;
@@ -59,8 +76,19 @@ queue_t *make_queue (size_t capacity, uint8_t *(*alloc)(size_t),
 	void (*release)(uint8_t *));
 
 
+/*\
+ * @brief Sets the overflow policy of the queue
+ * @param overflow The policy applied when enqueuing into a full queue
+ * @param queue_p Pointer to queue
+ * @return Zero on success; 1 on bad param
+\*/
+int set_queue_overflow (queue_overflow_t overflow, queue_t *queue_p);
+
+
 /*\
  * @brief Inserts an element into the queue
+ * @note Elements evicted under QUEUE_OVERFLOW_DROP_OLDEST are not returned;
+ *       use enqueue_evict if they must be released
  * @param elem_p Pointer to element to store
  * @param queue_p Pointer to queue
  * @return Zero on success; 1 on bad param; 2 on reached capacity
@@ -68,6 +96,17 @@ queue_t *make_queue (size_t capacity, uint8_t *(*alloc)(size_t),
 int enqueue (void *elem_p, queue_t *queue_p);
 
 
+/*\
+ * @brief Inserts an element into the queue, applying the overflow policy
+ * @param elem_p Pointer to element to store
+ * @param evicted_p_p Pointer at which to store the evicted element (set to
+ *        NULL if nothing was evicted; may be NULL)
+ * @param queue_p Pointer to queue
+ * @return Zero on success; 1 on bad param; 2 on reached capacity
+\*/
+int enqueue_evict (void *elem_p, void **evicted_p_p, queue_t *queue_p);
+
+
 /*\
  * @brief Returns a pointer to the oldest element of the queue
  * @note Does not dequeue the element.
@@ -86,6 +125,27 @@ int peek (void **elem_p_p, queue_t *queue_p);
 int dequeue (void **elem_p_p, queue_t *queue_p);
 
 
+/*\
+ * @brief Removes an element claimed with queue_wait_for_data
+ * @note The claim is spent either way. If another consumer took the element
+ *       first, this returns 2 and the caller goes back to waiting
+ * @param elem_p_p Pointer at which to copy dequeued element pointer
+ * @param queue_p Pointer to queue
+ * @return Zero on success; 1 on bad param; 2 on no data
+\*/
+int dequeue_claimed (void **elem_p_p, queue_t *queue_p);
+
+
+/*\
+ * @brief Blocks until the queue holds an element, and claims it
+ * @note The element is not reserved: another consumer may take it first.
+ *       Every claim must be spent with dequeue_claimed
+ * @param queue_p Pointer to queue
+ * @return Zero on success; 1 on bad param
+\*/
+int queue_wait_for_data (queue_t *queue_p);
+
+
 /*\
  * @brief Frees memory associated with queue
  * @param queue_p Pointer to queue
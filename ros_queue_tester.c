@@ -111,6 +111,48 @@ int main (void)
 	show_queue(queue_p, show); putchar('\n');
 
 
+	// Overflow policies on a small queue
+	printf("---- Overflow policies ----\n");
+	queue_t *small_p = make_queue(3, alloc, release);
+
+	// Drop-oldest keeps the newest elements
+	set_queue_overflow(QUEUE_OVERFLOW_DROP_OLDEST, small_p);
+	for (int i = 0; i < 5; ++i) {
+		if ((err = enqueue_evict((void *)strings[i], &elem_p, small_p)) != 0) {
+			printf("Err: Couldn't enqueue (%d)\n", err);
+			return EXIT_FAILURE;
+		}
+		if (elem_p != NULL) {
+			printf("Evicted \"%s\"\n", (char *)elem_p);
+			if (elem_p != strings[i - 3]) {
+				printf("Err: Evicted the wrong element\n");
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	show_queue(small_p, show); putchar('\n');
+	if (small_p->len != 3 || small_p->evicted != 2 ||
+		dequeue(&elem_p, small_p) != 0 || elem_p != strings[2]) {
+		printf("Err: Drop-oldest lost the order\n");
+		return EXIT_FAILURE;
+	}
+	enqueue((void *)strings[2], small_p);
+
+	// Reject-new refuses the element (until a dequeue frees a slot)
+	set_queue_overflow(QUEUE_OVERFLOW_REJECT, small_p);
+	if (enqueue((void *)strings[5], small_p) != 2 || small_p->rejected != 1) {
+		printf("Err: Reject-new accepted an element\n");
+		return EXIT_FAILURE;
+	}
+	dequeue(&elem_p, small_p);
+	if (enqueue((void *)strings[5], small_p) != 0) {
+		printf("Err: No space after dequeue\n");
+		return EXIT_FAILURE;
+	}
+	show_queue(small_p, show); putchar('\n');
+
+	destroy_queue(small_p);
+	destroy_queue(queue_p);
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,345 @@
+#include "ros_sched_analysis.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Maximum number of fixed-point iterations before giving up
+#define ANALYSIS_MAX_ITERATIONS      1000000
+
+/*
+ *******************************************************************************
+ *                        Internal Function Definitions                        *
+ *******************************************************************************
+*/
+
+
+static uint64_t ceil_div (uint64_t a, uint64_t b)
+{
+	return (a + b - 1) / b;
+}
+
+// True if task j delays task i under fixed priorities (as the executor does)
+static bool interferes (const analysis_task_t *tasks, off_t j, off_t i)
+{
+	sched_key_t key_i = {.prio = tasks[i].params.prio};
+	sched_key_t key_j = {.prio = tasks[j].params.prio};
+
+	if (j == i) {
+		return false;
+	}
+
+	// Equal keys: the lowest task index is picked first
+	return sched_key_precedes(SCHED_POLICY_FIXED_PRIO, &key_j, &key_i) ||
+		(!sched_key_precedes(SCHED_POLICY_FIXED_PRIO, &key_i, &key_j) && j < i);
+}
+
+// Demand of the higher priority tasks of i within a window (plus own demand)
+static uint64_t fixed_prio_demand (const analysis_task_t *tasks, size_t len,
+	off_t i, uint64_t window, uint64_t own)
+{
+	uint64_t demand = own;
+
+	for (off_t j = 0; j < len; ++j) {
+		if (interferes(tasks, j, i)) {
+			demand += ceil_div(window, tasks[j].params.period_ns) *
+				tasks[j].params.wcet_ns;
+		}
+	}
+
+	return demand;
+}
+
+// Marks a result as unbounded
+static void set_unbounded (analysis_result_t *result_p)
+{
+	*result_p = (analysis_result_t) {
+		.response_ns    = ANALYSIS_UNBOUNDED,
+		.schedulable    = false,
+		.required_depth = 0,
+		.depth_ok       = false
+	};
+}
+
+// Processor demand of all tasks for deadlines up to t
+static uint64_t edf_demand (const analysis_task_t *tasks, size_t len,
+	uint64_t t)
+{
+	uint64_t demand = 0;
+
+	for (off_t i = 0; i < len; ++i) {
+		uint64_t deadline = task_params_deadline(&(tasks[i].params));
+		if (t >= deadline) {
+			demand += ((t - deadline) / tasks[i].params.period_ns + 1) *
+				tasks[i].params.wcet_ns;
+		}
+	}
+
+	return demand;
+}
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+int read_analysis_tasks (FILE *file_p, analysis_task_t *tasks, size_t cap,
+	size_t *len_p)
+{
+	char line[256];
+	size_t len = 0, line_number = 0;
+
+	// Parameter check
+	if (file_p == NULL || tasks == NULL || len_p == NULL) {
+		return 1;
+	}
+
+	while (fgets(line, sizeof(line), file_p) != NULL) {
+		unsigned long period_us, wcet_us, deadline_us;
+		unsigned int prio;
+		size_t queue_depth;
+		char name[ANALYSIS_NAME_LENGTH];
+		char *p = line;
+
+		line_number++;
+
+		// Skip blank lines and comments
+		while (*p == ' ' || *p == '\t') {
+			p++;
+		}
+		if (*p == '#' || *p == '\n' || *p == '\0') {
+			continue;
+		}
+
+		if (sscanf(p, "%31s %lu %lu %u %lu %zu", name, &period_us, &wcet_us,
+			&prio, &deadline_us, &queue_depth) != 6 || period_us == 0 ||
+			prio > UINT8_MAX) {
+			fprintf(stderr, "%s:%d: Malformed task on line %zu\n",
+				__FILE__, __LINE__, line_number);
+			return 2;
+		}
+
+		if (len >= cap) {
+			fprintf(stderr, "%s:%d: Too many tasks (max %zu)\n",
+				__FILE__, __LINE__, cap);
+			return 3;
+		}
+
+		tasks[len] = (analysis_task_t) {
+			.params = (task_params_t) {
+				.period_ns   = period_us * NS_PER_USEC,
+				.wcet_ns     = wcet_us * NS_PER_USEC,
+				.deadline_ns = deadline_us * NS_PER_USEC,
+				.prio        = (uint8_t)prio
+			},
+			.queue_depth = queue_depth
+		};
+		strncpy(tasks[len].name, name, ANALYSIS_NAME_LENGTH - 1);
+		len++;
+	}
+
+	*len_p = len;
+
+	return 0;
+}
+
+
+double analysis_utilization (const analysis_task_t *tasks, size_t len)
+{
+	double u = 0.0;
+
+	for (off_t i = 0; i < len; ++i) {
+		u += (double)tasks[i].params.wcet_ns / tasks[i].params.period_ns;
+	}
+
+	return u;
+}
+
+
+int analyze_fixed_prio (const analysis_task_t *tasks, size_t len,
+	analysis_result_t *results)
+{
+	bool all_schedulable = true;
+
+	// Parameter check
+	if (tasks == NULL || results == NULL) {
+		return 1;
+	}
+
+	for (off_t i = 0; i < len; ++i) {
+		const task_params_t *params_p = &(tasks[i].params);
+		uint64_t busy = 0, response = 0, next;
+		size_t outstanding = 1;
+		double u = (double)params_p->wcet_ns / params_p->period_ns;
+		off_t iterations = 0;
+
+		// The level-i busy period is unbounded when overloaded
+		for (off_t j = 0; j < len; ++j) {
+			if (interferes(tasks, j, i)) {
+				u += (double)tasks[j].params.wcet_ns / tasks[j].params.period_ns;
+			}
+		}
+		if (u > 1.0) {
+			set_unbounded(results + i);
+			all_schedulable = false;
+			continue;
+		}
+
+		// Length of the level-i busy period
+		busy = params_p->wcet_ns;
+		while ((next = fixed_prio_demand(tasks, len, i, busy,
+			ceil_div(busy, params_p->period_ns) * params_p->wcet_ns)) != busy &&
+			++iterations < ANALYSIS_MAX_ITERATIONS) {
+			busy = next;
+		}
+
+		// Worst response over every job of the busy period
+		for (uint64_t q = 0; q < ceil_div(busy, params_p->period_ns) &&
+			iterations < ANALYSIS_MAX_ITERATIONS; ++q) {
+			uint64_t own = (q + 1) * params_p->wcet_ns, w = own;
+
+			while ((next = fixed_prio_demand(tasks, len, i, w, own)) != w &&
+				++iterations < ANALYSIS_MAX_ITERATIONS) {
+				w = next;
+			}
+
+			// Response of job q, and jobs released but not yet finished
+			if (w - q * params_p->period_ns > response) {
+				response = w - q * params_p->period_ns;
+			}
+			if (ceil_div(w, params_p->period_ns) - q > outstanding) {
+				outstanding = ceil_div(w, params_p->period_ns) - q;
+			}
+		}
+
+		if (iterations >= ANALYSIS_MAX_ITERATIONS) {
+			set_unbounded(results + i);
+			all_schedulable = false;
+			continue;
+		}
+
+		results[i] = (analysis_result_t) {
+			.response_ns    = response,
+			.schedulable    = (response <= task_params_deadline(params_p)),
+			.required_depth = outstanding,
+			.depth_ok       = (tasks[i].queue_depth >= outstanding)
+		};
+		all_schedulable &= results[i].schedulable;
+	}
+
+	return all_schedulable ? 0 : 2;
+}
+
+
+int analyze_edf (const analysis_task_t *tasks, size_t len,
+	analysis_result_t *results)
+{
+	double u = analysis_utilization(tasks, len);
+	uint64_t busy = 0, next, bound = 0, max_deadline = 0;
+	bool schedulable = true;
+	off_t iterations = 0;
+
+	// Parameter check
+	if (tasks == NULL || results == NULL) {
+		return 1;
+	}
+
+	// Necessary condition
+	if (u > 1.0) {
+		schedulable = false;
+	}
+
+	// Synchronous busy period bounds the deadlines to check
+	if (schedulable) {
+		for (off_t i = 0; i < len; ++i) {
+			busy += tasks[i].params.wcet_ns;
+		}
+		while (iterations++ < ANALYSIS_MAX_ITERATIONS) {
+			next = 0;
+			for (off_t i = 0; i < len; ++i) {
+				next += ceil_div(busy, tasks[i].params.period_ns) *
+					tasks[i].params.wcet_ns;
+			}
+			if (next == busy) {
+				break;
+			}
+			busy = next;
+		}
+		schedulable = (iterations < ANALYSIS_MAX_ITERATIONS);
+		bound = busy;
+	}
+
+	// When u < 1 the bound of Baruah et al. may be tighter
+	if (schedulable && u < 1.0) {
+		double la = 0.0;
+		for (off_t i = 0; i < len; ++i) {
+			uint64_t deadline = task_params_deadline(&(tasks[i].params));
+			double ui = (double)tasks[i].params.wcet_ns / tasks[i].params.period_ns;
+			if (deadline > max_deadline) {
+				max_deadline = deadline;
+			}
+			if (tasks[i].params.period_ns > deadline) {
+				la += (tasks[i].params.period_ns - deadline) * ui;
+			}
+		}
+		la /= (1.0 - u);
+		if ((uint64_t)la < max_deadline) {
+			la = (double)max_deadline;
+		}
+		if ((uint64_t)la < bound) {
+			bound = (uint64_t)la;
+		}
+	}
+
+	// Check the demand at every absolute deadline up to the bound
+	iterations = 0;
+	for (off_t i = 0; schedulable && i < len; ++i) {
+		uint64_t deadline = task_params_deadline(&(tasks[i].params));
+		for (uint64_t t = deadline; t <= bound; t += tasks[i].params.period_ns) {
+			if (edf_demand(tasks, len, t) > t ||
+				++iterations >= ANALYSIS_MAX_ITERATIONS) {
+				schedulable = false;
+				break;
+			}
+		}
+	}
+
+	// Jobs of a schedulable set finish by their deadline
+	for (off_t i = 0; i < len; ++i) {
+		uint64_t deadline = task_params_deadline(&(tasks[i].params));
+		size_t outstanding = ceil_div(deadline, tasks[i].params.period_ns);
+
+		if (!schedulable) {
+			set_unbounded(results + i);
+			continue;
+		}
+
+		results[i] = (analysis_result_t) {
+			.response_ns    = deadline,
+			.schedulable    = true,
+			.required_depth = outstanding,
+			.depth_ok       = (tasks[i].queue_depth >= outstanding)
+		};
+	}
+
+	return schedulable ? 0 : 2;
+}
+
+
+int analyze_task_set (sched_policy_t policy, const analysis_task_t *tasks,
+	size_t len, analysis_result_t *results)
+{
+	switch (policy) {
+		case SCHED_POLICY_EDF:
+			return analyze_edf(tasks, len, results);
+
+		case SCHED_POLICY_FIXED_PRIO:
+		default:
+			return analyze_fixed_prio(tasks, len, results);
+	}
+}
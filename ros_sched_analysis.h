@@ -0,0 +1,135 @@
+#if !defined(ROS_SCHED_ANALYSIS_H)
+#define ROS_SCHED_ANALYSIS_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 06/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Offline schedulability analysis of a task set (compile with -lm)           *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+#include "ros_sched_policy.h"
+#include "ros_time.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Maximum length of a task name in a task-set description
+#define ANALYSIS_NAME_LENGTH         32
+
+// Response time reported for tasks without a bounded response time
+#define ANALYSIS_UNBOUNDED           UINT64_MAX
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Structure: Describes a task of a task-set description
+typedef struct {
+	char name[ANALYSIS_NAME_LENGTH];      // Name of the task
+	task_params_t params;                 // Timing parameters
+	size_t queue_depth;                   // Depth of the task data queue
+} analysis_task_t;
+
+
+// Structure: Describes the analysis outcome for a task
+typedef struct {
+	uint64_t response_ns;                 // Worst-case response time
+	bool schedulable;                     // Response time within deadline
+	size_t required_depth;                // Queue depth that never drops
+	bool depth_ok;                        // Queue depth suffices
+} analysis_result_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Reads a task-set description. Each non-empty line not starting with
+ *        '#' holds: name period-us wcet-us prio deadline-us queue-depth
+ *        (a deadline of zero means the deadline equals the period)
+ * @param file_p  File to read from
+ * @param tasks   Array to store the tasks in
+ * @param cap     Capacity of the array
+ * @param len_p   Pointer at which to store the number of tasks read
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters
+ *         2: Malformed line (reported on stderr)
+ *         3: More tasks than fit in the array
+\*/
+int read_analysis_tasks (FILE *file_p, analysis_task_t *tasks, size_t cap,
+	size_t *len_p);
+
+
+/*\
+ * @brief Returns the total utilization of the tasks
+ * @param tasks Array of tasks
+ * @param len   Number of tasks
+ * @return Sum of WCET over period
+\*/
+double analysis_utilization (const analysis_task_t *tasks, size_t len);
+
+
+/*\
+ * @brief Fixed-priority response-time analysis (arbitrary deadlines, busy
+ *        period based). Interference follows sched_key_precedes, with equal
+ *        priorities resolved by task index like the executor does
+ * @param tasks   Array of tasks (index order matches task IDs)
+ * @param len     Number of tasks
+ * @param results Array of len results to fill in
+ * @return Zero if all tasks are schedulable; 1 on bad parameters; 2 otherwise
+\*/
+int analyze_fixed_prio (const analysis_task_t *tasks, size_t len,
+	analysis_result_t *results);
+
+
+/*\
+ * @brief EDF processor demand-bound test. Tasks of a schedulable set respond
+ *        within their deadline, which is reported as their response time
+ * @param tasks   Array of tasks
+ * @param len     Number of tasks
+ * @param results Array of len results to fill in
+ * @return Zero if the set is schedulable; 1 on bad parameters; 2 otherwise
+\*/
+int analyze_edf (const analysis_task_t *tasks, size_t len,
+	analysis_result_t *results);
+
+
+/*\
+ * @brief Runs the analysis matching the given policy
+ * @param policy  The scheduling policy
+ * @param tasks   Array of tasks
+ * @param len     Number of tasks
+ * @param results Array of len results to fill in
+ * @return As for the analysis of the policy
+\*/
+int analyze_task_set (sched_policy_t policy, const analysis_task_t *tasks,
+	size_t len, analysis_result_t *results);
+
+
+#endif
@@ -0,0 +1,52 @@
+#include "ros_sched_policy.h"
+
+#include <math.h>
+
+
+bool sched_key_precedes (sched_policy_t policy, const sched_key_t *a_p,
+	const sched_key_t *b_p)
+{
+	switch (policy) {
+		case SCHED_POLICY_EDF:
+			return a_p->deadline_ns < b_p->deadline_ns;
+
+		case SCHED_POLICY_CHAIN_SLACK:
+			return a_p->slack_ns < b_p->slack_ns;
+
+		case SCHED_POLICY_FIXED_PRIO:
+		default:
+			return a_p->prio > b_p->prio;
+	}
+}
+
+
+uint64_t task_params_deadline (const task_params_t *params_p)
+{
+	return (params_p->deadline_ns != 0) ? params_p->deadline_ns :
+		params_p->period_ns;
+}
+
+
+double sched_policy_utilization_bound (sched_policy_t policy, size_t n)
+{
+	switch (policy) {
+		case SCHED_POLICY_EDF:
+		case SCHED_POLICY_CHAIN_SLACK:
+			return 1.0;
+
+		case SCHED_POLICY_FIXED_PRIO:
+		default:
+			return (n == 0) ? 1.0 : n * (pow(2.0, 1.0 / n) - 1.0);
+	}
+}
+
+
+const char *sched_policy_name (sched_policy_t policy)
+{
+	switch (policy) {
+		case SCHED_POLICY_EDF:        return "EDF";
+		case SCHED_POLICY_CHAIN_SLACK: return "SLACK";
+		case SCHED_POLICY_FIXED_PRIO: return "FP";
+		default:                      return "?";
+	}
+}
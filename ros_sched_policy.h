@@ -0,0 +1,104 @@
+#if !defined(ROS_SCHED_POLICY_H)
+#define ROS_SCHED_POLICY_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 06/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Scheduling policies shared by the executor and the offline analysis        *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Enumeration: Scheduling policies
+typedef enum {
+	SCHED_POLICY_FIXED_PRIO = 0,          // Highest priority first
+	SCHED_POLICY_EDF,                     // Earliest absolute deadline first
+	SCHED_POLICY_CHAIN_SLACK              // Least remaining chain slack first
+} sched_policy_t;
+
+
+// Structure: Describes the declared timing parameters of a task
+typedef struct {
+	uint64_t period_ns;                   // Period or minimum inter-arrival
+	uint64_t wcet_ns;                     // Worst-case execution time
+	uint64_t deadline_ns;                 // Relative deadline (zero: period)
+	uint8_t prio;                         // Fixed priority (higher wins)
+} task_params_t;
+
+
+// Structure: Describes what a job competes with when scheduled
+typedef struct {
+	uint8_t prio;                         // Priority of the job
+	uint64_t deadline_ns;                 // Absolute deadline of the job
+	uint64_t slack_ns;                    // Latest start keeping its chain on
+	                                      // time (the deadline if unchained)
+} sched_key_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Returns true if job a must run before job b under the policy
+ * @note  Ties are not resolved here: the executor picks the lowest task
+ *        index among equal jobs, and the analysis assumes the same
+ * @param policy The scheduling policy
+ * @param a_p    Pointer to the key of job a
+ * @param b_p    Pointer to the key of job b
+ * @return True if a strictly precedes b
+\*/
+bool sched_key_precedes (sched_policy_t policy, const sched_key_t *a_p,
+	const sched_key_t *b_p);
+
+
+/*\
+ * @brief Returns the relative deadline of a task (the period if implicit)
+ * @param params_p Pointer to the task parameters
+ * @return Relative deadline in nanoseconds
+\*/
+uint64_t task_params_deadline (const task_params_t *params_p);
+
+
+/*\
+ * @brief Returns the utilization bound below which any set of n implicit
+ *        deadline tasks is schedulable under the policy
+ * @param policy The scheduling policy
+ * @param n      Number of tasks
+ * @return Utilization bound (Liu & Layland for fixed priorities; 1 for the
+ *         deadline driven policies)
+\*/
+double sched_policy_utilization_bound (sched_policy_t policy, size_t n);
+
+
+/*\
+ * @brief Returns the name of a policy
+ * @param policy The scheduling policy
+ * @return Policy name
+\*/
+const char *sched_policy_name (sched_policy_t policy);
+
+
+#endif
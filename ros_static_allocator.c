@@ -139,8 +139,7 @@ int static_free (static_allocator_t *static_allocator, uint8_t *block_ptr)
 	// Obtain block header (block_ptr - unit_size)
 	b = (block_h *)block_ptr - 1;
 
-	// Update available memory size
-	printf("[Adding %zu bytes]\n", b->d.size * unit_size);
+	// Update available memory size (the caller reports it)
 	static_allocator->free_memory_size += b->d.size * unit_size;
 
 	// Find insertion location for block
@@ -7,6 +7,122 @@
 */
 
 
+static bool task_id_is_valid (off_t task_id, task_set_t *task_set_p)
+{
+	return (task_id >= 0 && task_id < task_set_p->len &&
+		task_set_p->tasks[task_id].registered);
+}
+
+// True if the task is served by a worker pool (see set_group_type)
+static bool task_is_pooled (task_t *task_p, task_set_t *task_set_p)
+{
+	return (task_p->group != -1 &&
+		task_set_p->groups[task_p->group].type == TASK_GROUP_REENTRANT);
+}
+
+// True if the executor must meter the task: pool workers can't do that
+static bool task_is_metered (task_t *task_p)
+{
+	return (task_p->budget.budget_ns != 0 || task_p->server != -1 ||
+		task_p->crit.level == TASK_CRIT_HI || task_p->crit.wcet_lo_ns != 0);
+}
+
+// Configures a task slot to initial parameters
+static void init_task (task_t *task_p, queue_t *queue_p, bool registered)
+{
+	*task_p = (task_t) {
+		.pid = -1,
+		.cb  = NULL,
+		.queue = queue_p,
+		.registered = registered,
+		.active = false,
+		.n_active = 0,
+		.group = -1,
+		.server = -1,
+		.next_task = -1,
+		.chain = -1,
+		.chain_hop = -1,
+		.pool_len = 0,
+		.is_stopped = false,
+		.params = (task_params_t) {0},
+		.budget = (task_budget_t) {
+			.budget_ns = 0,
+			.timer_id  = -1
+		},
+		.crit = (task_crit_t) {
+			.level = TASK_CRIT_LO
+		}
+	};
+}
+
+// Returns the utilization (and count) of registered tasks with parameters
+static double task_set_utilization (task_set_t *task_set_p, size_t *n_p,
+	off_t *undeclared_p)
+{
+	double u = 0.0;
+	size_t n = 0;
+
+	*undeclared_p = -1;
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		task_t *task_p = task_set_p->tasks + i;
+		task_params_t *params_p = &(task_p->params);
+		if (!task_p->registered) {
+			continue;
+		}
+
+		// A running task without parameters has unknown utilization
+		if (params_p->period_ns == 0) {
+			if (task_p->pid > 0 || task_p->pool_len > 0) {
+				*undeclared_p = i;
+			}
+			continue;
+		}
+		u += (double)params_p->wcet_ns / params_p->period_ns;
+		n++;
+	}
+
+	*n_p = n;
+
+	return u;
+}
+
+// Returns a free task slot, growing the task array if all are in use
+static off_t task_set_take_slot (task_set_t *task_set_p)
+{
+	task_t *tasks = NULL;
+	queue_t *queue_p = NULL;
+	size_t cap = task_set_p->cap;
+
+	// Reuse a slot of a deregistered task
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		if (!task_set_p->tasks[i].registered) {
+			return i;
+		}
+	}
+
+	// Grow the array (copying the tasks over) if it is full
+	if (task_set_p->len == cap) {
+		cap = (cap == 0) ? 1 : 2 * cap;
+		if ((tasks = (task_t *)task_set_p->alloc(cap * sizeof(task_t)))
+			== NULL) {
+			return -1;
+		}
+		memcpy(tasks, task_set_p->tasks, task_set_p->len * sizeof(task_t));
+		task_set_p->release((uint8_t *)task_set_p->tasks);
+		task_set_p->tasks = tasks;
+		task_set_p->cap = cap;
+	}
+
+	// Append a slot with a new queue
+	if ((queue_p = make_queue(task_set_p->queue_depth, task_set_p->alloc,
+		task_set_p->release)) == NULL) {
+		return -1;
+	}
+	init_task(task_set_p->tasks + task_set_p->len, queue_p, false);
+
+	return task_set_p->len++;
+}
+
 static task_callback_t *task_has_data (task_t *task_p)
 {
 	void *data_ptr = NULL;
@@ -18,237 +134,2641 @@ static task_callback_t *task_has_data (task_t *task_p)
 	}
 }
 
-static void show_task_element (void * const element)
+// Discards expired callbacks at the queue head (or anywhere if whole_queue)
+static size_t purge_expired_callbacks (task_t *task_p, uint64_t now_ns,
+	bool whole_queue, task_set_t *task_set_p)
+{
+	task_callback_t *callback_p = NULL;
+	size_t purged = 0;
+
+	// Expired heads are simply popped
+	while (peek((void **)&callback_p, task_p->queue) == 0 &&
+		callback_p->expiry_ns < now_ns) {
+		dequeue((void **)&callback_p, task_p->queue);
+		free_task_callback(callback_p, task_set_p);
+		purged++;
+	}
+
+	// Others are found by rotating through the queue (keeping order)
+	for (size_t n = whole_queue ? task_p->queue->len : 0; n > 0; --n) {
+		dequeue((void **)&callback_p, task_p->queue);
+		if (callback_p->expiry_ns < now_ns) {
+			free_task_callback(callback_p, task_set_p);
+			purged++;
+		} else {
+			enqueue(callback_p, task_p->queue);
+		}
+	}
+
+	task_p->expired += purged;
+
+	return purged;
+}
+
+// Copies data into a new payload block (without references yet)
+static int make_callback_data (size_t data_size, void *data,
+	task_callback_data_t **callback_data_p_p, task_set_t *task_set_p)
+{
+	task_callback_data_t *callback_data_p = NULL;
+	void *data_copy = NULL;
+
+	// Allocate a copy of the memory provided
+	if ((data_copy = (void *)task_set_p->alloc(data_size)) == NULL) {
+		fprintf(stderr, "%s:%d: Unable to allocate copy of memory!\n",
+			__FILE__, __LINE__);
+		return 3;
+	} else {
+		memcpy(data_copy, data, data_size);
+	}
+
+	// Allocate the callback data pointer
+	if ((callback_data_p = 
+		(task_callback_data_t *)task_set_p->alloc(sizeof(task_callback_data_t))) 
+		== NULL) {
+		fprintf(stderr, "%s:%d: Unable to allocate task callback data!\n",
+			__FILE__, __LINE__);
+		task_set_p->release((uint8_t *)data_copy);
+		return 4;
+	} else {
+		*callback_data_p = (task_callback_data_t){
+			.data_p = data_copy,
+			.data_size = data_size,
+			.refs = 0
+		};
+	}
+
+	*callback_data_p_p = callback_data_p;
+
+	return 0;
+}
+
+// Releases a payload block that no callback refers to
+static void release_unused_callback_data (task_callback_data_t *callback_data_p,
+	task_set_t *task_set_p)
+{
+	if (callback_data_p->refs == 0) {
+		task_set_p->release((uint8_t *)(callback_data_p->data_p));
+		task_set_p->release((uint8_t *)callback_data_p);
+	}
+}
+
+// Stamps a callback descriptor for arrival at a task
+static void stamp_callback (task_callback_t *callback_p, task_t *task,
+	uint8_t prio, const task_callback_attr_t *attr_p)
+{
+	uint64_t now_ns = time_now_ns();
+	uint64_t deadline_ns = (attr_p != NULL && attr_p->deadline_ns != 0) ?
+		attr_p->deadline_ns : task_params_deadline(&(task->params));
+	uint64_t lifespan_ns = (attr_p != NULL && attr_p->lifespan_ns != 0) ?
+		attr_p->lifespan_ns : task->lifespan_ns;
+
+	callback_p->prio = prio;
+	callback_p->arrival_ns = now_ns;
+	callback_p->dispatch_ns = 0;
+	callback_p->completion_ns = 0;
+	callback_p->deadline_ns = (deadline_ns != 0) ? now_ns + deadline_ns :
+		UINT64_MAX;
+	callback_p->expiry_ns = (lifespan_ns != 0) ? now_ns + lifespan_ns :
+		UINT64_MAX;
+}
+
+// Computes the latest start of a callback for its chain to be on time
+static void stamp_chain_slack (task_callback_t *callback_p, task_t *task,
+	task_set_t *task_set_p)
+{
+	task_chain_t *chain_p = NULL;
+	uint64_t remaining_ns = 0;
+
+	// Unchained callbacks (or chains without deadline) use their deadline
+	callback_p->slack_ns = callback_p->deadline_ns;
+	if (callback_p->chain == -1 || callback_p->chain != task->chain ||
+		(chain_p = task_set_p->chains + callback_p->chain)->deadline_ns == 0) {
+		return;
+	}
+
+	// Leave room for the worst-case execution of the remaining hops
+	for (off_t hop = task->chain_hop; hop < chain_p->len; ++hop) {
+		remaining_ns += task_set_p->tasks[chain_p->tasks[hop]].params.wcet_ns;
+	}
+	callback_p->slack_ns = callback_p->root_arrival_ns + chain_p->deadline_ns -
+		remaining_ns;
+}
+
+// Frees a chain. Its tasks stay linked by their edges, but no longer stamp
+// or record chain instances
+static void dissolve_chain (off_t chain_id, task_set_t *task_set_p)
+{
+	task_chain_t *chain_p = task_set_p->chains + chain_id;
+
+	for (off_t hop = 0; hop < chain_p->len; ++hop) {
+		task_t *task_p = task_set_p->tasks + chain_p->tasks[hop];
+		task_p->chain = -1;
+		task_p->chain_hop = -1;
+	}
+	chain_p->len = 0;
+}
+
+// Records the end-to-end latency of a chain instance
+static void record_chain_latency (task_chain_t *chain_p, uint64_t latency_ns)
+{
+	histogram_record(latency_ns / NS_PER_USEC, &(chain_p->latency));
+	if (chain_p->deadline_ns != 0 && latency_ns > chain_p->deadline_ns) {
+		chain_p->misses++;
+	}
+}
+
+// Moves the overload window forward to the given time
+static void advance_overload_window (task_overload_t *overload_p,
+	uint64_t now_ns)
+{
+	uint64_t slot_ns = overload_p->window_ns / TASK_OVERLOAD_SLOTS;
+	bool busy = (overload_p->busy_since_ns != 0);
+
+	// Restart the window if all of it has passed
+	if (now_ns - overload_p->slot_start_ns >= overload_p->window_ns + slot_ns) {
+		for (off_t i = 0; i < TASK_OVERLOAD_SLOTS; ++i) {
+			overload_p->busy_ns[i]   = busy ? slot_ns : 0;
+			overload_p->occupancy[i] = 0.0;
+		}
+		overload_p->busy_ns[overload_p->slot] = 0;
+		overload_p->slot_start_ns = now_ns;
+		overload_p->busy_since_ns = busy ? now_ns : 0;
+		return;
+	}
+
+	// Close each slot passed, crediting the stretch running through it
+	while (now_ns - overload_p->slot_start_ns >= slot_ns) {
+		overload_p->slot_start_ns += slot_ns;
+		if (busy) {
+			overload_p->busy_ns[overload_p->slot] += overload_p->slot_start_ns -
+				overload_p->busy_since_ns;
+			overload_p->busy_since_ns = overload_p->slot_start_ns;
+		}
+		overload_p->slot = (overload_p->slot + 1) % TASK_OVERLOAD_SLOTS;
+		overload_p->busy_ns[overload_p->slot] = 0;
+		overload_p->occupancy[overload_p->slot] = 0.0;
+	}
+}
+
+// Sheds a callback for a task in overload. True if it must not be queued
+static bool shed_callback (task_t *task, task_set_t *task_set_p)
+{
+	void *data_p = NULL;
+
+	if (task_set_p->overload.window_ns == 0 ||
+		task->criticality >= task_set_p->overload.shed_below ||
+		!update_overload(NULL, NULL, task_set_p)) {
+		return false;
+	}
+
+	task->shed++;
+
+	// Keep the newest only: drop everything queued before it
+	if (task->shed_action == TASK_SHED_KEEP_LATEST) {
+		while (dequeue(&data_p, task->queue) == 0) {
+			free_task_callback((task_callback_t *)data_p, task_set_p);
+		}
+		return false;
+	}
+
+	return true;
+}
+
+// Returns the CPU time consumed by the calling process
+static uint64_t process_cpu_ns (void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == -1) {
+		return 0;
+	}
+
+	return time_timespec_to_ns(&ts);
+}
+
+// Switches between LO and HI mode
+static void set_criticality_mode (task_crit_level_t mode, off_t task_id,
+	task_set_t *task_set_p)
+{
+	if (task_set_p->mode == mode) {
+		return;
+	}
+
+	task_set_p->mode = mode;
+	if (mode == TASK_CRIT_HI) {
+		task_set_p->mode_switches++;
+		LOG(LOG_HI_MODE, task_id);
+	} else {
+		LOG(LOG_LO_MODE, 0);
+
+		// Resume the pool workers of suspended tasks
+		for (; task_set_p->parked > 0; task_set_p->parked--) {
+			sem_post(&(task_set_p->lo_mode));
+		}
+	}
+}
+
+// Accounts the CPU time of a job against the WCETs of its task
+static void check_job_wcet (off_t task_id, uint64_t cpu_ns,
+	task_set_t *task_set_p)
+{
+	task_crit_t *crit_p = &(task_set_p->tasks[task_id].crit);
+
+	if (crit_p->wcet_lo_ns == 0 || cpu_ns <= crit_p->wcet_lo_ns) {
+		return;
+	}
+
+	crit_p->overruns++;
+	if (crit_p->wcet_hi_ns != 0 && cpu_ns > crit_p->wcet_hi_ns) {
+		crit_p->hi_overruns++;
+		fprintf(stderr, "%s:%d: Task %ld ran past its HI-mode WCET\n",
+			__FILE__, __LINE__, task_id);
+	}
+	if (crit_p->level == TASK_CRIT_HI) {
+		set_criticality_mode(TASK_CRIT_HI, task_id, task_set_p);
+	}
+}
+
+// Builds the scheduling key of a callback
+static sched_key_t callback_key (task_callback_t *callback_p)
+{
+	return (sched_key_t) {
+		.prio        = callback_p->prio,
+		.deadline_ns = callback_p->deadline_ns,
+		.slack_ns    = callback_p->slack_ns
+	};
+}
+
+// Puts a stamped callback in the queue of a task. Returns as the enqueue
+static int queue_callback (task_t *task, task_callback_t *callback_p,
+	task_set_t *task_set_p)
+{
+	task_callback_t *evicted_p = NULL;
+	int err;
+
+	// Make room by discarding stale data first
+	if (task->queue->len >= task->queue->cap) {
+		purge_expired_callbacks(task, callback_p->arrival_ns, true, task_set_p);
+	}
+
+	// Enqueue this for the given task (applying its overflow policy)
+	if ((err = enqueue_evict(callback_p, (void **)&evicted_p, task->queue))
+		!= 0) {
+		fprintf(stderr, "%s:%d: Unable to enqueue data with given task!\n",
+			__FILE__, __LINE__);
+		return 6;
+	}
+
+	// Release the callback the newest one displaced
+	if (evicted_p != NULL) {
+		free_task_callback(evicted_p, task_set_p);
+	}
+
+	// Note the queue fill for the overload controller
+	if (task_set_p->overload.window_ns != 0 && task->queue->cap != 0) {
+		task_overload_t *overload_p = &(task_set_p->overload);
+		double occupancy = (double)task->queue->len / task->queue->cap;
+		advance_overload_window(overload_p, callback_p->arrival_ns);
+		if (occupancy > overload_p->occupancy[overload_p->slot]) {
+			overload_p->occupancy[overload_p->slot] = occupancy;
+		}
+	}
+
+	return 0;
+}
+
+// Applies the admission checks to an arrival. True if it must be discarded
+static bool discard_arrival (off_t task_id, uint8_t prio, task_t *task,
+	task_set_t *task_set_p)
+{
+	TRACE(TRACE_ARRIVAL, task_id, prio);
+
+	// A previous deadline miss may discard this job
+	if (task->deadlines.skip_next) {
+		task->deadlines.skip_next = false;
+		task->deadlines.skipped++;
+		return true;
+	}
+
+	// Non-critical work is shed in overload
+	return shed_callback(task, task_set_p);
+}
+
+// Queues a callback referring to a payload block for a (valid) task
+static int enqueue_callback_data (off_t task_id, uint8_t prio,
+	const task_callback_attr_t *attr_p, task_callback_data_t *callback_data_p,
+	task_set_t *task_set_p)
+{
+	task_t *task = task_set_p->tasks + task_id;
+	task_callback_t *callback_p = NULL;
+	int err;
+
+	// Skipped and shed jobs are not an error
+	if (discard_arrival(task_id, prio, task, task_set_p)) {
+		return 0;
+	}
+
+	// Allocate the callback data descriptor
+	if ((callback_p = (task_callback_t *)task_set_p->alloc(sizeof(task_callback_t))) 
+		== NULL) {
+		fprintf(stderr, "%s:%d: Unable to allocate task callback descriptor!\n",
+			__FILE__, __LINE__);
+		return 5;
+	} else {
+		stamp_callback(callback_p, task, prio, attr_p);
+		callback_p->callback_data = callback_data_p;
+		callback_data_p->refs++;
+
+		// Fresh data starts an instance of the chain headed by the task
+		callback_p->chain = (task->chain_hop == 0) ? task->chain : -1;
+		callback_p->root_arrival_ns = callback_p->arrival_ns;
+		stamp_chain_slack(callback_p, task, task_set_p);
+	}
+
+	// Enqueue (the descriptor is dropped if that fails)
+	if ((err = queue_callback(task, callback_p, task_set_p)) != 0) {
+		callback_data_p->refs--;
+		task_set_p->release((uint8_t *)callback_p);
+	} else {
+		TRACE(TRACE_ENQUEUE, task_id, task->queue->len);
+	}
+
+	return err;
+}
+
+static bool task_is_candidate (task_t *task_p, uint64_t now_ns,
+	sched_key_t *key_p, bool *demoted_p, task_set_t *task_set_p)
+{
+	task_callback_t *head = NULL;
+	task_group_t *group_p = NULL;
+	uint64_t arrival_ns;
+
+	// Free slots never compete, nor do tasks released by a schedule table
+	if (!task_p->registered || task_p->time_triggered) {
+		return false;
+	}
+
+	// Respect the callback group
+	if (task_p->group != -1) {
+		group_p = task_set_p->groups + task_p->group;
+
+		// Reentrant tasks are served by their worker pool
+		if (group_p->type == TASK_GROUP_REENTRANT) {
+			return false;
+		}
+
+		// Wait while another member has a callback underway
+		if (group_p->active > task_p->n_active) {
+			return false;
+		}
+	}
+
+	// Compete with the callback underway, else with the next queued one
+	if (task_p->active) {
+		*key_p = task_p->active_key;
+		arrival_ns = task_p->active_arrival_ns;
+	} else if ((head = task_has_data(task_p)) != NULL) {
+		*key_p = callback_key(head);
+		arrival_ns = head->arrival_ns;
+	} else {
+		return false;
+	}
+
+	// Age the priority by one level per step waited (up to the cap)
+	if (task_p->aging.step_ns != 0 && key_p->prio < task_p->aging.cap &&
+		now_ns > arrival_ns) {
+		uint64_t steps = (now_ns - arrival_ns) / task_p->aging.step_ns;
+		key_p->prio = (steps >= (uint64_t)(task_p->aging.cap -
+			key_p->prio)) ? task_p->aging.cap : key_p->prio + steps;
+	}
+
+	// Apply the HI-mode treatment and the budget exhaustion action
+	*demoted_p = false;
+	if (task_set_p->mode == TASK_CRIT_HI &&
+		task_p->crit.level == TASK_CRIT_LO) {
+		if (task_p->crit.action == TASK_CRIT_SUSPEND) {
+			return false;
+		}
+		*demoted_p = true;
+	}
+	if (atomic_load(&(task_p->budget.exhausted))) {
+		if (task_p->budget.action == TASK_BUDGET_SUSPEND) {
+			return false;
+		}
+		*demoted_p = true;
+	}
+
+	return true;
+}
+
+static void show_task_element (void * const element)
+{
+	task_callback_t *cb = (task_callback_t *)element;
+	printf("{.prio = %d, {.data_size = %zu, .data_p = %p}",
+		cb->prio, cb->callback_data->data_size, cb->callback_data->data_p); 
+}
+
+static int add_task_timer (task_timer_type_t type, off_t task_id, uint8_t prio,
+	uint64_t delay_ns, uint64_t period_ns, off_t *timer_id_p,
+	task_set_t *task_set_p)
+{
+	task_timer_t *timer_p = NULL;
+
+	// Parameter check
+	if (task_set_p == NULL || task_set_p->timers == NULL) {
+		fprintf(stderr, "%s:%d: Null parameters or timers disabled!\n",
+			__FILE__, __LINE__);
+		return 1;
+	}
+
+	// Task ID check (server timers act on a server)
+	if (type == TASK_TIMER_SERVER_REPLENISH ? (task_id < 0 ||
+		task_id >= TASK_MAX_SERVERS) : !task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	// Allocate the timer descriptor
+	if ((timer_p = (task_timer_t *)task_set_p->alloc(sizeof(task_timer_t)))
+		== NULL) {
+		fprintf(stderr, "%s:%d: Unable to allocate timer descriptor!\n",
+			__FILE__, __LINE__);
+		return 3;
+	} else {
+		*timer_p = (task_timer_t) {
+			.type    = type,
+			.task_id = task_id,
+			.prio    = prio
+		};
+	}
+
+	// Round the expiry and period up to whole ticks
+	uint64_t tick_ns = task_set_p->timer_tick_ns;
+	uint64_t expiry = (time_now_ns() + delay_ns + tick_ns - 1) / tick_ns;
+	uint64_t period = (period_ns + tick_ns - 1) / tick_ns;
+
+	// Arm the timer
+	if (timer_wheel_add(expiry, period, timer_p, timer_id_p,
+		task_set_p->timers) != 0) {
+		fprintf(stderr, "%s:%d: Timer wheel is full!\n", __FILE__, __LINE__);
+		task_set_p->release((uint8_t *)timer_p);
+		return 4;
+	}
+
+	return 0;
+}
+
+
+// True if a server has a budget and used it up
+static bool server_is_exhausted (const task_server_t *server_p)
+{
+	return server_p->budget_ns != 0 && server_p->remaining_ns <= 0;
+}
+
+// Charges the time a task ran since the last start to its servers
+static void charge_servers (off_t task_id, uint64_t now_ns,
+	task_set_t *task_set_p)
+{
+	uint64_t used_ns = now_ns - task_set_p->run_start_ns;
+
+	// Disarm the depletion timer
+	if (task_set_p->depletion_timer_id != -1) {
+		cancel_timer_for_task(task_set_p->depletion_timer_id, task_set_p);
+		task_set_p->depletion_timer_id = -1;
+	}
+
+	if (task_id == -1) {
+		return;
+	}
+
+	for (off_t id = task_set_p->tasks[task_id].server; id != -1;
+		id = task_set_p->servers[id].parent) {
+		task_server_t *server_p = task_set_p->servers + id;
+		bool exhausted = server_is_exhausted(server_p);
+		server_p->consumed_ns += used_ns;
+		if (server_p->budget_ns == 0) {
+			continue;
+		}
+		server_p->remaining_ns -= (int64_t)used_ns;
+		if (!exhausted && server_is_exhausted(server_p)) {
+			server_p->exhaustions++;
+		}
+	}
+}
+
+// Starts charging a task to its servers, arming a timer for the first of
+// them to run out
+static void start_servers (off_t task_id, uint64_t now_ns,
+	task_set_t *task_set_p)
+{
+	int64_t remaining_ns = INT64_MAX;
+
+	task_set_p->run_start_ns = now_ns;
+	if (task_id == -1 || task_set_p->timers == NULL) {
+		return;
+	}
+
+	for (off_t id = task_set_p->tasks[task_id].server; id != -1;
+		id = task_set_p->servers[id].parent) {
+		task_server_t *server_p = task_set_p->servers + id;
+		if (server_p->budget_ns != 0 && server_p->remaining_ns < remaining_ns) {
+			remaining_ns = server_p->remaining_ns;
+		}
+	}
+
+	if (remaining_ns != INT64_MAX) {
+		add_task_timer(TASK_TIMER_SERVER_DEPLETE, task_id, 0,
+			(remaining_ns > 0) ? remaining_ns : 0, 0,
+			&(task_set_p->depletion_timer_id), task_set_p);
+	}
+}
+
+static void on_timer_expiry (off_t timer_id, void *data, void *arg)
+{
+	task_timer_t *timer_p = (task_timer_t *)data;
+	task_set_t *task_set_p = (task_set_t *)arg;
+	task_t *task_p = NULL;
+	int err;
+
+	// Server timers settle the time charged so far (refilling on replenish)
+	if (timer_p->type == TASK_TIMER_SERVER_REPLENISH ||
+		timer_p->type == TASK_TIMER_SERVER_DEPLETE) {
+		uint64_t now_ns = time_now_ns();
+		off_t running_task_id = task_set_p->current_running_task_id;
+		if (timer_p->type == TASK_TIMER_SERVER_DEPLETE) {
+			task_set_p->depletion_timer_id = -1;
+			task_set_p->release((uint8_t *)timer_p);
+		}
+		charge_servers(running_task_id, now_ns, task_set_p);
+		if (timer_p->type == TASK_TIMER_SERVER_REPLENISH) {
+			task_server_t *server_p = task_set_p->servers + timer_p->task_id;
+			server_p->remaining_ns = server_p->budget_ns;
+			server_p->period_start_ns = now_ns;
+		}
+		start_servers(running_task_id, now_ns, task_set_p);
+		return;
+	}
+
+	// Replenishment timers restore the full budget (re-metering if running)
+	task_p = task_set_p->tasks + timer_p->task_id;
+	if (timer_p->type == TASK_TIMER_REPLENISH) {
+		bool accounting = task_p->budget.accounting;
+		stop_task_budget(timer_p->task_id, task_set_p);
+		task_p->budget.remaining_ns = task_p->budget.budget_ns;
+		atomic_store(&(task_p->budget.exhausted), false);
+		if (accounting) {
+			start_task_budget(timer_p->task_id, task_set_p);
+		}
+		return;
+	}
+
+	// Describe the expiry to the callback (the wheel is past the due tick)
+	task_timer_event_t event = (task_timer_event_t) {
+		.timer_id  = timer_id,
+		.expiry_ns = (task_set_p->timers->tick - 1) *
+			task_set_p->timer_tick_ns
+	};
+
+	// Enqueue the callback (errors are reported by the enqueue routine)
+	if ((err = enqueue_callback_for_task(timer_p->task_id, timer_p->prio,
+		sizeof(event), &event, task_set_p)) != 0) {
+		fprintf(stderr, "%s:%d: Timer %ld dropped a callback (%d)\n",
+			__FILE__, __LINE__, timer_id, err);
+	}
+
+	// One-shot timers are already removed from the wheel
+	if (task_set_p->timers->timers[timer_id].armed == false) {
+		task_set_p->release((uint8_t *)timer_p);
+	}
+}
+
+// Picks the best task among the members of a server (-1: the top level).
+// Nested servers compete on behalf of their own best member
+// Picks the task to run among the members of a server. A probe changes
+// nothing: expired callbacks stay queued (and may still compete)
+static int pick_in_server (off_t server_id, uint64_t now_ns, bool probe,
+	sched_key_t *key_p, bool *demoted_p, task_set_t *task_set_p)
+{
+	int prio_task_index = -1;
+	sched_key_t curr_key, best_key;
+	bool curr_demoted = false, best_demoted = false;
+	sched_policy_t policy = (server_id == -1) ? task_set_p->policy :
+		task_set_p->servers[server_id].policy;
+
+	// Iterate across the tasks of the server
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		task_t *task_p = task_set_p->tasks + i;
+
+		if (task_p->server != server_id) {
+			continue;
+		}
+
+		// Never wake a task just to find its data expired
+		if (task_p->registered && !task_p->active && !probe) {
+			purge_expired_callbacks(task_p, now_ns, false, task_set_p);
+		}
+
+		// Don't consider tasks that have no work or may not run
+		if (!task_is_candidate(task_p, now_ns, &curr_key, &curr_demoted,
+			task_set_p)) {
+			if (!probe) {
+				LOG(LOG_TASK_SKIPPED, i);
+			}
+			continue;
+		}
+
+		// Set task if none is set
+		if (prio_task_index == -1) {
+			if (!probe) {
+				LOG(LOG_TASK_DEFAULT, i);
+			}
+			prio_task_index = i;
+			best_key = curr_key;
+			best_demoted = curr_demoted;
+			continue;
+		}
+
+		// Demoted tasks lose to all others; otherwise apply the policy
+		if ((best_demoted && !curr_demoted) || (best_demoted == curr_demoted &&
+			sched_key_precedes(policy, &curr_key, &best_key))) {
+			if (!probe) {
+				LOG(LOG_TASK_PREFERRED, i, prio_task_index);
+			}
+			prio_task_index = i;
+			best_key = curr_key;
+			best_demoted = curr_demoted;
+		}
+	}
+
+	// Nested servers with budget left compete as one
+	for (off_t id = 0; id < TASK_MAX_SERVERS; ++id) {
+		task_server_t *server_p = task_set_p->servers + id;
+		int i;
+
+		if (!server_p->in_use || server_p->parent != server_id ||
+			server_is_exhausted(server_p) || (i = pick_in_server(id, now_ns,
+			probe, &curr_key, &curr_demoted, task_set_p)) == -1) {
+			continue;
+		}
+
+		// Periodic servers carry their own priority and period deadline
+		if (server_p->budget_ns != 0) {
+			curr_key.prio = server_p->prio;
+			curr_key.deadline_ns = curr_key.slack_ns =
+				server_p->period_start_ns + server_p->period_ns;
+		}
+
+		// Equal keys: the lowest task index is picked first
+		if (prio_task_index == -1 || (best_demoted && !curr_demoted) ||
+			(best_demoted == curr_demoted &&
+			(sched_key_precedes(policy, &curr_key, &best_key) ||
+			(!sched_key_precedes(policy, &best_key, &curr_key) &&
+			i < prio_task_index)))) {
+			prio_task_index = i;
+			best_key = curr_key;
+			best_demoted = curr_demoted;
+		}
+	}
+
+	*key_p = best_key;
+	*demoted_p = best_demoted;
+
+	return prio_task_index;
+}
+
+// True if a worker has exited (unreaped workers linger as zombies)
+static bool worker_is_dead (pid_t pid)
+{
+	char path[32], state = '\0';
+	FILE *file_p = NULL;
+
+	if (pid <= 0) {
+		return false;
+	}
+	if (kill(pid, 0) == -1 && errno == ESRCH) {
+		return true;
+	}
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+	if ((file_p = fopen(path, "r")) == NULL) {
+		return (errno == ENOENT);
+	}
+	if (fscanf(file_p, "%*d (%*[^)]) %c", &state) != 1) {
+		state = '\0';
+	}
+	fclose(file_p);
+
+	return (state == 'Z' || state == 'X');
+}
+
+// Undoes the scheduling state held by dead workers (after an owner died
+// inside a critical section). Returns the number of tasks repaired
+static size_t repair_task_set (task_set_t *task_set_p)
+{
+	size_t repaired = 0;
+
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		task_t *task_p = task_set_p->tasks + i;
+		size_t workers = 0, n_active = task_p->n_active;
+		bool dead = false;
+
+		if (!task_p->registered) {
+			continue;
+		}
+
+		// Forget dead pool workers; each ran at most one callback
+		for (off_t j = 0; j < task_p->pool_len; ++j) {
+			if (worker_is_dead(task_p->pool[j])) {
+				task_p->pool[j--] = task_p->pool[--task_p->pool_len];
+			}
+		}
+		workers = task_p->pool_len;
+
+		// A dead worker no longer runs (nor will it ever complete)
+		if ((dead = worker_is_dead(task_p->pid))) {
+			task_p->pid = -1;
+			task_p->is_stopped = true;
+			if (task_set_p->current_running_task_id == i) {
+				set_running_task(-1, task_set_p);
+			}
+		} else if (task_p->pid > 0) {
+			workers++;
+		}
+
+		// Callbacks underway can't outnumber the live workers
+		if (task_p->n_active > workers) {
+			task_p->n_active = workers;
+		}
+		if (task_p->group != -1) {
+			task_set_p->groups[task_p->group].active -=
+				(n_active - task_p->n_active);
+		}
+		task_p->active = (task_p->n_active > 0);
+
+		if (dead || n_active != task_p->n_active) {
+			repaired++;
+		}
+	}
+
+	return repaired;
+}
+
+// Copies the state monitors care about into the snapshot (under the lock)
+static void publish_task_stats (task_set_t *task_set_p)
+{
+	task_stats_t *stats_p = task_set_p->stats;
+	size_t len = task_set_p->len;
+
+	if (len > TASK_STATS_MAX_TASKS) {
+		len = TASK_STATS_MAX_TASKS;
+	}
+
+	task_stats_write_begin(stats_p);
+
+	stats_p->published_ns = time_now_ns();
+	stats_p->publications++;
+	stats_p->running_task_id = task_set_p->current_running_task_id;
+	stats_p->overloaded = task_set_p->overload.overloaded;
+	stats_p->hi_mode = (task_set_p->mode == TASK_CRIT_HI);
+	stats_p->mode_switches = task_set_p->mode_switches;
+	stats_p->overload_transitions = task_set_p->overload.transitions;
+	stats_p->len = len;
+	stats_p->dropped = task_set_p->len - len;
+
+	for (off_t i = 0; i < len; ++i) {
+		task_t *task_p = task_set_p->tasks + i;
+		stats_p->tasks[i] = (task_stats_entry_t) {
+			.pid                = task_p->pid,
+			.registered         = task_p->registered,
+			.active             = task_p->active,
+			.stopped            = task_p->is_stopped,
+			.queue_len          = task_p->queue->len,
+			.queue_cap          = task_p->queue->cap,
+			.dispatches         = task_p->dispatches,
+			.completions        = task_p->deadlines.completions,
+			.misses             = task_p->deadlines.misses,
+			.expired            = task_p->expired,
+			.rejected           = task_p->queue->rejected,
+			.evicted            = task_p->queue->evicted,
+			.shed               = task_p->shed,
+			.last_dispatch_ns   = task_p->last_dispatch_ns,
+			.last_completion_ns = task_p->last_completion_ns
+		};
+	}
+
+	task_stats_write_end(stats_p);
+}
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+task_set_t *make_task_set (size_t len, size_t queue_depth,
+ uint8_t *(*alloc)(size_t), void (*release)(uint8_t *))
+{
+	task_set_t *task_set_p = NULL;
+	task_t *tasks = NULL;
+
+	// Parameter check
+	if (alloc == NULL || release == NULL) {
+		return NULL;
+	}
+
+	// Allocate task set
+	if ((task_set_p = (task_set_t *)alloc(sizeof(task_set_t))) == NULL) {
+		return NULL;
+	}
+
+	// Allocate task array
+	if ((tasks = (task_t *)alloc(len * sizeof(task_t))) == NULL) {
+		return NULL;
+	}
+
+	// Configure all tasks to initial parameters
+	for (off_t i = 0; i < len; ++i) {
+		queue_t *queue_p = NULL;
+
+		// Allocate the task queue
+		if ((queue_p = make_queue(queue_depth, alloc, release)) == NULL) {
+			return NULL;
+		}
+
+		init_task(tasks + i, queue_p, true);
+	}
+
+	// Configure the task set
+	task_set_p->policy  = SCHED_POLICY_FIXED_PRIO;
+	task_set_p->current_running_task_id = -1;
+	task_set_p->len     = len;
+	task_set_p->cap     = len;
+	task_set_p->queue_depth = queue_depth;
+	task_set_p->tasks   = tasks;
+	memset(task_set_p->groups, 0, sizeof(task_set_p->groups));
+	memset(task_set_p->chains, 0, sizeof(task_set_p->chains));
+	memset(&(task_set_p->overload), 0, sizeof(task_set_p->overload));
+	memset(task_set_p->servers, 0, sizeof(task_set_p->servers));
+	task_set_p->run_start_ns = 0;
+	task_set_p->depletion_timer_id = -1;
+	task_set_p->mode = TASK_CRIT_LO;
+	task_set_p->mode_switches = 0;
+	task_set_p->parked = 0;
+	task_set_p->timers  = NULL;
+	task_set_p->timer_tick_ns = 0;
+	task_set_p->stats   = NULL;
+	task_set_p->stats_dirty = false;
+	task_set_p->alloc   = alloc;
+	task_set_p->release = release;
+
+	// Initialize the shared semaphore
+	int pshared = 1; // Inter-process
+	if (sem_init(&(task_set_p->sem), pshared, 1) == -1 ||
+		sem_init(&(task_set_p->lo_mode), pshared, 0) == -1) {
+		perror("sem_init");
+	}
+	task_set_p->lock_type = TASK_LOCK_SEMAPHORE;
+	task_set_p->lock_recoveries = 0;
+
+	return task_set_p;
+}
+
+
+int set_task_set_lock (task_lock_type_t type, task_set_t *task_set_p)
+{
+	pthread_mutexattr_t attr;
+	int err;
+
+	// Parameter check
+	if (task_set_p == NULL || (type != TASK_LOCK_SEMAPHORE &&
+		type != TASK_LOCK_PI_MUTEX)) {
+		return 1;
+	}
+
+	// Nothing to do if unchanged
+	if (type == task_set_p->lock_type) {
+		return 0;
+	}
+
+	if (type == TASK_LOCK_SEMAPHORE) {
+		pthread_mutex_destroy(&(task_set_p->mutex));
+		task_set_p->lock_type = type;
+		return 0;
+	}
+
+	// Shared between processes, inheriting priority, surviving its owner
+	if ((err = pthread_mutexattr_init(&attr)) != 0 ||
+		(err = pthread_mutexattr_setpshared(&attr,
+			PTHREAD_PROCESS_SHARED)) != 0 ||
+		(err = pthread_mutexattr_setprotocol(&attr,
+			PTHREAD_PRIO_INHERIT)) != 0 ||
+		(err = pthread_mutexattr_setrobust(&attr,
+			PTHREAD_MUTEX_ROBUST)) != 0 ||
+		(err = pthread_mutex_init(&(task_set_p->mutex), &attr)) != 0) {
+		fprintf(stderr, "%s:%d: Unable to create the mutex (%s)\n",
+			__FILE__, __LINE__, strerror(err));
+		pthread_mutexattr_destroy(&attr);
+		return 2;
+	}
+	pthread_mutexattr_destroy(&attr);
+
+	task_set_p->lock_type = type;
+
+	return 0;
+}
+
+
+int lock_task_set (task_set_t *task_set_p)
+{
+	size_t repaired;
+	int err;
+
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	if (task_set_p->lock_type == TASK_LOCK_SEMAPHORE) {
+		while (sem_wait(&(task_set_p->sem)) == -1) {
+			if (errno != EINTR) {
+				perror("sem_wait");
+				return 2;
+			}
+		}
+		return 0;
+	}
+
+	// The owner died inside its critical section: repair what it left
+	if ((err = pthread_mutex_lock(&(task_set_p->mutex))) == EOWNERDEAD) {
+		repaired = repair_task_set(task_set_p);
+		task_set_p->lock_recoveries++;
+		fprintf(stderr, "%s:%d: Task set lock owner died (repaired %zu "
+			"tasks)\n", __FILE__, __LINE__, repaired);
+		err = pthread_mutex_consistent(&(task_set_p->mutex));
+	}
+
+	if (err != 0) {
+		fprintf(stderr, "%s:%d: Unable to lock the task set (%s)\n",
+			__FILE__, __LINE__, strerror(err));
+		return 2;
+	}
+
+	return 0;
+}
+
+
+// Releases the task set lock without marking the snapshot stale
+static int release_task_set (task_set_t *task_set_p)
+{
+	if (task_set_p->lock_type == TASK_LOCK_SEMAPHORE) {
+		return (sem_post(&(task_set_p->sem)) == -1) ? 2 : 0;
+	}
+
+	return (pthread_mutex_unlock(&(task_set_p->mutex)) != 0) ? 2 : 0;
+}
+
+
+int unlock_task_set (task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	task_set_p->stats_dirty = true;
+
+	return release_task_set(task_set_p);
+}
+
+
+int get_highest_prio_task_index (task_set_t *task_set_p)
+{
+	int prio_task_index = -1;
+	sched_key_t best_key;
+	bool best_demoted = false;
+	uint64_t now_ns = time_now_ns();
+
+	// Parameter check
+	if (task_set_p == NULL) {
+		fprintf(stderr, "%s:%d: get_highest_prio_task has NULL param!\n",
+			__FILE__, __LINE__);
+		return -1;
+	}
+
+	// Pick from the top level down through the servers
+	prio_task_index = pick_in_server(-1, now_ns, false, &best_key,
+		&best_demoted, task_set_p);
+
+	// An idle instant ends HI mode, letting LO-criticality tasks run again
+	if (prio_task_index == -1 && task_set_p->mode == TASK_CRIT_HI) {
+		set_criticality_mode(TASK_CRIT_LO, -1, task_set_p);
+		return get_highest_prio_task_index(task_set_p);
+	}
+
+	return prio_task_index;
+}
+
+int set_task_params (off_t task_id, const task_params_t *params_p,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (params_p == NULL || task_set_p == NULL) {
+		fprintf(stderr, "%s:%d: Null parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].params = *params_p;
+
+	return 0;
+}
+
+int register_task (const task_params_t *params_p, off_t *task_id_p,
+	task_set_t *task_set_p)
+{
+	size_t n = 0;
+	double u = 0.0, bound = 0.0;
+	off_t task_id = -1, undeclared = -1;
+
+	// Parameter check
+	if (params_p == NULL || task_id_p == NULL || task_set_p == NULL ||
+		params_p->period_ns == 0 || params_p->wcet_ns == 0) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Admission control
+	u = task_set_utilization(task_set_p, &n, &undeclared) +
+		(double)params_p->wcet_ns / params_p->period_ns;
+	if (undeclared != -1) {
+		fprintf(stderr, "%s:%d: Admission rejected (task %ld runs without "
+			"declared parameters)\n", __FILE__, __LINE__, undeclared);
+		return 2;
+	}
+	bound = sched_policy_utilization_bound(task_set_p->policy, n + 1);
+	if (u > bound) {
+		fprintf(stderr, "%s:%d: Admission rejected (U = %.3f > %.3f)\n",
+			__FILE__, __LINE__, u, bound);
+		return 2;
+	}
+
+	// Find (or make) a slot
+	if ((task_id = task_set_take_slot(task_set_p)) == -1) {
+		fprintf(stderr, "%s:%d: Unable to allocate a task slot!\n",
+			__FILE__, __LINE__);
+		return 3;
+	}
+
+	init_task(task_set_p->tasks + task_id, task_set_p->tasks[task_id].queue,
+		true);
+	task_set_p->tasks[task_id].params = *params_p;
+	*task_id_p = task_id;
+
+	return 0;
+}
+
+int deregister_task (off_t task_id, task_set_t *task_set_p)
+{
+	task_t *task_p = NULL;
+	void *data_p = NULL;
+
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task %ld is not registered\n",
+			__FILE__, __LINE__, task_id);
+		return 2;
+	}
+
+	// A callback underway still refers to the task
+	if ((task_p = task_set_p->tasks + task_id)->n_active != 0) {
+		fprintf(stderr, "%s:%d: Task %ld has a callback underway\n",
+			__FILE__, __LINE__, task_id);
+		return 3;
+	}
+
+	// Remove the budget (and its replenishment timer)
+	if (task_p->budget.budget_ns != 0) {
+		set_task_budget(task_id, 0, 0, TASK_BUDGET_DEMOTE, task_set_p);
+	}
+	if (task_p->budget.has_cpu_timer) {
+		timer_delete(task_p->budget.cpu_timer);
+	}
+	if (task_p->crit.has_cpu_timer) {
+		timer_delete(task_p->crit.cpu_timer);
+	}
+
+	// Cancel the callback timers of the task
+	if (task_set_p->timers != NULL) {
+		for (off_t i = 0; i < task_set_p->timers->cap; ++i) {
+			wheel_timer_t *timer_p = task_set_p->timers->timers + i;
+			if (timer_p->armed &&
+				((task_timer_t *)timer_p->data)->task_id == task_id) {
+				cancel_timer_for_task(i, task_set_p);
+			}
+		}
+	}
+
+	// Release the queued callbacks
+	while (dequeue(&data_p, task_p->queue) == 0) {
+		free_task_callback((task_callback_t *)data_p, task_set_p);
+	}
+
+	if (task_set_p->current_running_task_id == task_id) {
+		set_running_task(-1, task_set_p);
+	}
+
+	// Leave the callback group
+	set_task_group(task_id, -1, task_set_p);
+
+	// Drop its chain and the edges into it (the slot may be reused)
+	if (task_p->chain != -1) {
+		dissolve_chain(task_p->chain, task_set_p);
+	}
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		if (task_set_p->tasks[i].next_task == task_id) {
+			task_set_p->tasks[i].next_task = -1;
+		}
+	}
+
+	// Free the slot (the queue is kept for reuse)
+	init_task(task_p, task_p->queue, false);
+
+	return 0;
+}
+
+int enqueue_callback_for_task (off_t task_id, uint8_t prio, size_t data_size, void *data, 
+	task_set_t *task_set_p)
+{
+	return enqueue_callback_for_task_attr(task_id, prio, NULL, data_size, data,
+		task_set_p);
+}
+
+int enqueue_callback_for_task_attr (off_t task_id, uint8_t prio,
+	const task_callback_attr_t *attr_p, size_t data_size, void *data,
+	task_set_t *task_set_p)
+{
+	task_callback_data_t *callback_data_p = NULL;
+	int err;
+
+	// Verify parameters
+	if (data == NULL || task_set_p == NULL) {
+		fprintf(stderr, "%s:%d: Null parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Verify parameters
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task index is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	// Copy the data into a payload block
+	if ((err = make_callback_data(data_size, data, &callback_data_p,
+		task_set_p)) != 0) {
+		return err;
+	}
+
+	err = enqueue_callback_data(task_id, prio, attr_p, callback_data_p,
+		task_set_p);
+
+	// Release the payload if the callback wasn't queued
+	release_unused_callback_data(callback_data_p, task_set_p);
+
+	return err;
+}
+
+int subscribe_task (off_t task_id, off_t topic_id, bool subscribe,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || topic_id < 0 || topic_id >= TASK_MAX_TOPICS) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	if (subscribe) {
+		task_set_p->tasks[task_id].topics |= (1ULL << topic_id);
+	} else {
+		task_set_p->tasks[task_id].topics &= ~(1ULL << topic_id);
+	}
+
+	return 0;
+}
+
+int publish_callback (off_t topic_id, uint8_t prio, size_t data_size,
+	void *data, size_t *delivered_p, task_set_t *task_set_p)
+{
+	task_callback_data_t *callback_data_p = NULL;
+	size_t delivered = 0;
+	int err;
+
+	// Parameter check
+	if (data == NULL || task_set_p == NULL || topic_id < 0 ||
+		topic_id >= TASK_MAX_TOPICS) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// One copy of the data is shared by all subscribers
+	if ((err = make_callback_data(data_size, data, &callback_data_p,
+		task_set_p)) != 0) {
+		return err;
+	}
+
+	// Fan out to every subscriber (failures only affect that subscriber)
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		task_t *task_p = task_set_p->tasks + i;
+		if (!task_p->registered || (task_p->topics & (1ULL << topic_id)) == 0) {
+			continue;
+		}
+		if (enqueue_callback_data(i, prio, NULL, callback_data_p, task_set_p)
+			== 0) {
+			delivered++;
+		}
+	}
+
+	// Release the payload if no subscriber took it
+	release_unused_callback_data(callback_data_p, task_set_p);
+
+	if (delivered_p != NULL) {
+		*delivered_p = delivered;
+	}
+
+	return 0;
+}
+
+int set_task_lifespan (off_t task_id, uint64_t lifespan_ns,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].lifespan_ns = lifespan_ns;
+
+	return 0;
+}
+
+int set_task_overflow (off_t task_id, queue_overflow_t overflow,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	return set_queue_overflow(overflow, task_set_p->tasks[task_id].queue);
+}
+
+// Dequeues a callback for a task (a claimed one for pool workers)
+static int dequeue_callback (off_t task_id, bool claimed,
+	task_callback_t **task_callback_p_p, task_set_t *task_set_p)
+{
+	int err;
+
+	// Parameter check
+	if (task_callback_p_p == NULL || task_set_p == NULL) {
+		fprintf(stderr, "%s:%d: Null parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			 __FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	// Locate the task
+	task_t *task = task_set_p->tasks + task_id;
+
+	// Discard stale data
+	purge_expired_callbacks(task, time_now_ns(), false, task_set_p);
+
+	// Dequeue
+	if ((err = claimed ? dequeue_claimed((void **)task_callback_p_p,
+		task->queue) : dequeue((void **)task_callback_p_p, task->queue)) != 0) {
+		fprintf(stderr, "%s:%d: Unable to dequeue (%d)!\n", __FILE__, 
+			__LINE__, err);
+		return 3;
+	}
+
+	return 0;
+}
+
+int dequeue_callback_for_task (off_t task_id, task_callback_t **task_callback_p_p,
+	task_set_t *task_set_p)
+{
+	return dequeue_callback(task_id, false, task_callback_p_p, task_set_p);
+}
+
+int dequeue_claimed_callback_for_task (off_t task_id,
+	task_callback_t **task_callback_p_p, task_set_t *task_set_p)
+{
+	return dequeue_callback(task_id, true, task_callback_p_p, task_set_p);
+}
+
+bool pool_task_suspended (off_t task_id, task_set_t *task_set_p)
+{
+	task_t *task_p = NULL;
+
+	// Parameter check
+	if (task_set_p == NULL || !task_id_is_valid(task_id, task_set_p)) {
+		return false;
+	}
+
+	// Throttling only lowers the priority, which a pool doesn't compete with
+	task_p = task_set_p->tasks + task_id;
+	if (task_set_p->mode != TASK_CRIT_HI || task_p->crit.level !=
+		TASK_CRIT_LO || task_p->crit.action != TASK_CRIT_SUSPEND) {
+		return false;
+	}
+
+	task_set_p->parked++;
+	return true;
+}
+
+int wait_for_lo_mode (task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	while (sem_wait(&(task_set_p->lo_mode)) == -1) {
+		if (errno != EINTR) {
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int begin_task_callback (off_t task_id, task_callback_t *callback_p,
+	task_set_t *task_set_p)
+{
+	task_t *task_p = NULL;
+
+	// Parameter check
+	if (callback_p == NULL || task_set_p == NULL ||
+		!task_id_is_valid(task_id, task_set_p)) {
+		return 1;
+	}
+
+	task_p = task_set_p->tasks + task_id;
+
+	// Stamp the dispatch and compete with this callback from now on
+	callback_p->dispatch_ns = time_now_ns();
+	callback_p->cpu_start_ns = process_cpu_ns();
+	if (getpid() == task_p->pid) {
+		task_p->crit.job_cpu_start_ns = callback_p->cpu_start_ns;
+	}
+	task_p->dispatches++;
+	task_p->last_dispatch_ns = callback_p->dispatch_ns;
+	task_p->active = true;
+	task_p->active_key = callback_key(callback_p);
+	task_p->active_arrival_ns = callback_p->arrival_ns;
+	task_p->n_active++;
+	if (task_p->group != -1) {
+		task_set_p->groups[task_p->group].active++;
+	}
+
+	return 0;
+}
+
+int complete_task_callback (off_t task_id, task_callback_t *callback_p,
+	task_set_t *task_set_p)
+{
+	task_t *task_p = NULL;
+	task_deadline_stats_t *stats_p = NULL;
+	void *data_p = NULL;
+	uint64_t lateness_ns, cpu_ns;
+
+	// Parameter check
+	if (callback_p == NULL || task_set_p == NULL ||
+		!task_id_is_valid(task_id, task_set_p)) {
+		return 1;
+	}
+
+	task_p = task_set_p->tasks + task_id;
+	stats_p = &(task_p->deadlines);
+
+	// The callback is no longer underway
+	if (task_p->n_active > 0) {
+		task_p->n_active--;
+		if (task_p->group != -1) {
+			task_set_p->groups[task_p->group].active--;
+		}
+	}
+	task_p->active = (task_p->n_active > 0);
+
+	// Stamp the completion and compare with the deadline
+	callback_p->completion_ns = time_now_ns();
+	task_p->last_completion_ns = callback_p->completion_ns;
+	stats_p->completions++;
+
+	// Check the CPU time of the job against its WCETs (and count it)
+	cpu_ns = process_cpu_ns() - callback_p->cpu_start_ns;
+	check_job_wcet(task_id, cpu_ns, task_set_p);
+	if (task_set_p->stats != NULL) {
+		task_stats_record_latency(task_id,
+			callback_p->dispatch_ns - callback_p->arrival_ns, cpu_ns,
+			callback_p->completion_ns - callback_p->arrival_ns,
+			task_set_p->stats);
+	}
+
+	// The last hop completes an instance of the chain
+	if (callback_p->chain != -1 && callback_p->chain == task_p->chain &&
+		task_p->chain_hop ==
+		task_set_p->chains[callback_p->chain].len - 1) {
+		record_chain_latency(task_set_p->chains + callback_p->chain,
+			callback_p->completion_ns - callback_p->root_arrival_ns);
+	}
+
+	if (callback_p->completion_ns <= callback_p->deadline_ns) {
+		return 0;
+	}
+
+	// Account the miss
+	lateness_ns = callback_p->completion_ns - callback_p->deadline_ns;
+	stats_p->misses++;
+	stats_p->total_lateness_ns += lateness_ns;
+	if (lateness_ns > stats_p->max_lateness_ns) {
+		stats_p->max_lateness_ns = lateness_ns;
+	}
+
+	switch (stats_p->action) {
+
+		// Discard the oldest queued job, or else the next one to arrive
+		case TASK_MISS_SKIP_NEXT:
+			if (dequeue(&data_p, task_p->queue) == 0) {
+				free_task_callback((task_callback_t *)data_p, task_set_p);
+				stats_p->skipped++;
+			} else {
+				stats_p->skip_next = true;
+			}
+			break;
+
+		// Discard queued jobs whose deadline already passed (keeping order)
+		case TASK_MISS_DROP_STALE:
+			for (size_t n = task_p->queue->len; n > 0; --n) {
+				task_callback_t *queued_p = NULL;
+				dequeue((void **)&queued_p, task_p->queue);
+				if (queued_p->deadline_ns < callback_p->completion_ns) {
+					free_task_callback(queued_p, task_set_p);
+					stats_p->skipped++;
+				} else {
+					enqueue(queued_p, task_p->queue);
+				}
+			}
+			break;
+
+		case TASK_MISS_LOG:
+		default:
+			break;
+	}
+
+	fprintf(stderr, "Task %ld missed its deadline by %" PRIu64 " us "
+		"(queued %" PRIu64 " us, ran %" PRIu64 " us)\n", task_id,
+		lateness_ns / NS_PER_USEC,
+		(callback_p->dispatch_ns - callback_p->arrival_ns) / NS_PER_USEC,
+		(callback_p->completion_ns - callback_p->dispatch_ns) / NS_PER_USEC);
+
+	return 2;
+}
+
+int set_task_miss_action (off_t task_id, task_miss_action_t action,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].deadlines.action = action;
+	task_set_p->tasks[task_id].deadlines.skip_next = false;
+
+	return 0;
+}
+
+int set_group_type (off_t group_id, task_group_type_t type, size_t pool_size,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || group_id < 0 || group_id >= TASK_MAX_GROUPS ||
+		(type == TASK_GROUP_REENTRANT &&
+		(pool_size == 0 || pool_size > TASK_MAX_POOL))) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Members would be left with the wrong workers
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		if (task_set_p->tasks[i].registered &&
+			task_set_p->tasks[i].group == group_id) {
+			fprintf(stderr, "%s:%d: Group %ld has members\n", __FILE__,
+				__LINE__, group_id);
+			return 2;
+		}
+	}
+
+	task_set_p->groups[group_id].type = type;
+	task_set_p->groups[group_id].pool_size =
+		(type == TASK_GROUP_REENTRANT) ? pool_size : 0;
+
+	return 0;
+}
+
+int set_task_group (off_t task_id, off_t group_id, task_set_t *task_set_p)
+{
+	task_t *task_p = NULL;
+
+	// Parameter check
+	if (task_set_p == NULL || group_id < -1 || group_id >= TASK_MAX_GROUPS) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	// Group counts must stay balanced
+	if ((task_p = task_set_p->tasks + task_id)->n_active != 0) {
+		fprintf(stderr, "%s:%d: Task %ld has a callback underway\n",
+			__FILE__, __LINE__, task_id);
+		return 3;
+	}
+
+	// Pool workers run without the executor metering them
+	if (group_id != -1 && task_set_p->groups[group_id].type ==
+		TASK_GROUP_REENTRANT && task_is_metered(task_p)) {
+		fprintf(stderr, "%s:%d: Task %ld has a budget, WCET or server\n",
+			__FILE__, __LINE__, task_id);
+		return 4;
+	}
+
+	task_p->group = group_id;
+
+	return 0;
+}
+
+size_t task_pool_size (off_t task_id, task_set_t *task_set_p)
+{
+	off_t group_id;
+
+	// Parameter check
+	if (task_set_p == NULL || !task_id_is_valid(task_id, task_set_p) ||
+		(group_id = task_set_p->tasks[task_id].group) == -1) {
+		return 0;
+	}
+
+	return task_set_p->groups[group_id].pool_size;
+}
+
+int set_chain_edge (off_t task_id, off_t next_task_id, uint8_t prio,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || next_task_id == task_id ||
+		(next_task_id != -1 && !task_id_is_valid(next_task_id, task_set_p))) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].next_task = next_task_id;
+	task_set_p->tasks[task_id].next_prio = prio;
+
+	return 0;
+}
+
+int define_chain (const off_t *tasks, size_t len, uint64_t deadline_ns,
+	uint8_t prio, off_t *chain_id_p, task_set_t *task_set_p)
+{
+	task_chain_t *chain_p = NULL;
+	off_t chain_id = -1;
+
+	// Parameter check
+	if (tasks == NULL || chain_id_p == NULL || task_set_p == NULL ||
+		len == 0 || len > TASK_CHAIN_MAX_LEN) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// Each task may only appear once, in one chain
+	for (off_t i = 0; i < len; ++i) {
+		if (!task_id_is_valid(tasks[i], task_set_p) ||
+			task_set_p->tasks[tasks[i]].chain != -1) {
+			fprintf(stderr, "%s:%d: Task %ld is unknown or already chained\n",
+				__FILE__, __LINE__, tasks[i]);
+			return 2;
+		}
+		for (off_t j = 0; j < i; ++j) {
+			if (tasks[j] == tasks[i]) {
+				fprintf(stderr, "%s:%d: Task %ld is repeated\n",
+					__FILE__, __LINE__, tasks[i]);
+				return 2;
+			}
+		}
+	}
+
+	// Find an unused chain
+	for (off_t i = 0; i < TASK_MAX_CHAINS && chain_id == -1; ++i) {
+		if (task_set_p->chains[i].len == 0) {
+			chain_id = i;
+		}
+	}
+	if (chain_id == -1) {
+		fprintf(stderr, "%s:%d: All chains are in use!\n", __FILE__, __LINE__);
+		return 3;
+	}
+
+	// Configure the chain
+	chain_p = task_set_p->chains + chain_id;
+	memset(chain_p, 0, sizeof(task_chain_t));
+	memcpy(chain_p->tasks, tasks, len * sizeof(off_t));
+	chain_p->len = len;
+	chain_p->deadline_ns = deadline_ns;
+
+	// Link the hops
+	for (off_t i = 0; i < len; ++i) {
+		task_set_p->tasks[tasks[i]].chain = chain_id;
+		task_set_p->tasks[tasks[i]].chain_hop = i;
+		set_chain_edge(tasks[i], (i + 1 < len) ? tasks[i + 1] : -1, prio,
+			task_set_p);
+	}
+
+	*chain_id_p = chain_id;
+
+	return 0;
+}
+
+int show_chain_latency (off_t chain_id, task_set_t *task_set_p)
+{
+	task_chain_t *chain_p = NULL;
+
+	// Parameter check
+	if (task_set_p == NULL || chain_id < 0 || chain_id >= TASK_MAX_CHAINS ||
+		(chain_p = task_set_p->chains + chain_id)->len == 0) {
+		return 1;
+	}
+
+	printf("Chain %ld: %" PRIu64 " late\n", chain_id, chain_p->misses);
+	show_histogram("end-to-end", "us", &(chain_p->latency));
+
+	return 0;
+}
+
+int forward_task_output (off_t task_id, task_callback_t *callback_p,
+	off_t *fused_task_id_p, task_set_t *task_set_p)
+{
+	task_t *next_p = NULL;
+	off_t next_task_id;
+	sched_key_t key;
+	bool demoted;
+
+	// Parameter check
+	if (callback_p == NULL || fused_task_id_p == NULL || task_set_p == NULL ||
+		!task_id_is_valid(task_id, task_set_p)) {
+		return 1;
+	}
+
+	*fused_task_id_p = -1;
+
+	// Nothing to forward without a chain edge
+	if ((next_task_id = task_set_p->tasks[task_id].next_task) == -1) {
+		return 2;
+	}
+
+	// The successor may have gone away
+	if (!task_id_is_valid(next_task_id, task_set_p)) {
+		task_set_p->tasks[task_id].next_task = -1;
+		return 2;
+	}
+
+	// Re-stamp the same descriptor (and buffer) for the successor
+	next_p = task_set_p->tasks + next_task_id;
+	stamp_callback(callback_p, next_p, task_set_p->tasks[task_id].next_prio,
+		NULL);
+	stamp_chain_slack(callback_p, next_p, task_set_p);
+
+	// Admit it like any other arrival
+	if (discard_arrival(next_task_id, callback_p->prio, next_p, task_set_p)) {
+		free_task_callback(callback_p, task_set_p);
+		return 0;
+	}
+	if (queue_callback(next_p, callback_p, task_set_p) != 0) {
+		free_task_callback(callback_p, task_set_p);
+		return 0;
+	}
+	TRACE(TRACE_ENQUEUE, next_task_id, next_p->queue->len);
+
+	// Fuse if the successor is idle and then wins (probing, so selection
+	// changes nothing until the executor or the successor really runs it)
+	if (next_p->n_active == 0 && !task_is_pooled(next_p, task_set_p) &&
+		pick_in_server(-1, time_now_ns(), true, &key, &demoted,
+		task_set_p) == next_task_id) {
+		next_p->fused++;
+		*fused_task_id_p = next_task_id;
+	}
+
+	return 0;
+}
+
+int set_task_aging (off_t task_id, uint64_t step_ns, uint8_t cap,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].aging = (task_aging_t) {
+		.step_ns = step_ns,
+		.cap     = cap
+	};
+
+	return 0;
+}
+
+void set_running_task (off_t task_id, task_set_t *task_set_p)
+{
+	task_overload_t *overload_p = &(task_set_p->overload);
+	off_t running_task_id = task_set_p->current_running_task_id;
+	uint64_t now_ns;
+
+	if (task_id == running_task_id) {
+		return;
+	}
+	task_set_p->current_running_task_id = task_id;
+
+	// Charge the servers of the task that ran, and meter the next one
+	now_ns = time_now_ns();
+	charge_servers(running_task_id, now_ns, task_set_p);
+	start_servers(task_id, now_ns, task_set_p);
+
+	// Account busy stretches only while the controller is enabled
+	if (overload_p->window_ns == 0 || (running_task_id == -1) == (task_id == -1)) {
+		return;
+	}
+
+	advance_overload_window(overload_p, now_ns);
+	if (task_id != -1) {
+		overload_p->busy_since_ns = now_ns;
+	} else if (overload_p->busy_since_ns != 0) {
+		overload_p->busy_ns[overload_p->slot] += now_ns -
+			overload_p->busy_since_ns;
+		overload_p->busy_since_ns = 0;
+	}
+}
+
+int set_overload_control (uint64_t window_ns, double high_util,
+	double low_util, double high_occupancy, double low_occupancy,
+	uint8_t shed_below, task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || low_util > high_util ||
+		low_occupancy > high_occupancy ||
+		(window_ns != 0 && window_ns < TASK_OVERLOAD_SLOTS)) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	task_set_p->overload = (task_overload_t) {
+		.window_ns      = window_ns,
+		.high_util      = high_util,
+		.low_util       = low_util,
+		.high_occupancy = high_occupancy,
+		.low_occupancy  = low_occupancy,
+		.shed_below     = shed_below,
+		.overloaded     = false,
+		.slot           = 0,
+		.slot_start_ns  = time_now_ns(),
+		.busy_since_ns  = (task_set_p->current_running_task_id != -1) ?
+			time_now_ns() : 0
+	};
+
+	return 0;
+}
+
+bool update_overload (double *util_p, double *occupancy_p,
+	task_set_t *task_set_p)
+{
+	task_overload_t *overload_p = &(task_set_p->overload);
+	uint64_t now_ns = time_now_ns(), busy_ns = 0, span_ns;
+	double util, occupancy = 0.0;
+
+	if (overload_p->window_ns == 0) {
+		return false;
+	}
+
+	advance_overload_window(overload_p, now_ns);
+
+	// Sum the window (including the stretch running now)
+	for (off_t i = 0; i < TASK_OVERLOAD_SLOTS; ++i) {
+		busy_ns += overload_p->busy_ns[i];
+		if (overload_p->occupancy[i] > occupancy) {
+			occupancy = overload_p->occupancy[i];
+		}
+	}
+	if (overload_p->busy_since_ns != 0) {
+		busy_ns += now_ns - overload_p->busy_since_ns;
+	}
+	span_ns = (TASK_OVERLOAD_SLOTS - 1) *
+		(overload_p->window_ns / TASK_OVERLOAD_SLOTS) +
+		(now_ns - overload_p->slot_start_ns);
+	util = (span_ns == 0) ? 0.0 : (double)busy_ns / span_ns;
+
+	// Enter on either level, leave only when both are low (hysteresis)
+	if (!overload_p->overloaded && (util >= overload_p->high_util ||
+		occupancy >= overload_p->high_occupancy)) {
+		overload_p->overloaded = true;
+		overload_p->transitions++;
+	} else if (overload_p->overloaded && util <= overload_p->low_util &&
+		occupancy <= overload_p->low_occupancy) {
+		overload_p->overloaded = false;
+	}
+
+	if (util_p != NULL) {
+		*util_p = util;
+	}
+	if (occupancy_p != NULL) {
+		*occupancy_p = occupancy;
+	}
+
+	return overload_p->overloaded;
+}
+
+int show_overload (task_set_t *task_set_p)
+{
+	double util, occupancy;
+	bool overloaded;
+
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	if (task_set_p->overload.window_ns == 0) {
+		printf("Overload control is off\n");
+		return 0;
+	}
+
+	overloaded = update_overload(&util, &occupancy, task_set_p);
+	printf("Overload: %s (entered %" PRIu64 " times), utilization %.1f%%, "
+		"queue fill %.1f%%\n", overloaded ? "shedding" : "normal",
+		task_set_p->overload.transitions, 100.0 * util, 100.0 * occupancy);
+
+	for (off_t i = 0; i < task_set_p->len; ++i) {
+		task_t *task = task_set_p->tasks + i;
+		if (task->registered) {
+			printf("  Task %ld: criticality %u, %" PRIu64 " shed\n", i,
+				task->criticality, task->shed);
+		}
+	}
+
+	return 0;
+}
+
+int set_task_criticality (off_t task_id, uint8_t criticality,
+	task_shed_action_t action, task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].criticality = criticality;
+	task_set_p->tasks[task_id].shed_action = action;
+
+	return 0;
+}
+
+int set_task_drain (off_t task_id, bool drain, task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].drain = drain;
+
+	return 0;
+}
+
+bool task_may_continue (off_t task_id, task_set_t *task_set_p)
+{
+	sched_key_t key;
+	bool demoted;
+
+	// Parameter check
+	if (task_set_p == NULL || !task_id_is_valid(task_id, task_set_p) ||
+		!task_set_p->tasks[task_id].drain) {
+		return false;
+	}
+
+	// Yield if anything else should run now (probing: the worker leaves
+	// purges, logging and mode changes to the executor)
+	if (pick_in_server(-1, time_now_ns(), true, &key, &demoted,
+		task_set_p) != task_id) {
+		return false;
+	}
+
+	task_set_p->tasks[task_id].drained++;
+
+	return true;
+}
+
+int free_task_callback (task_callback_t *callback_p, task_set_t *task_set_p)
+{
+	// Parameter check
+	if (callback_p == NULL || task_set_p == NULL) {
+		fprintf(stderr, "%s:%d: Null parameters!\n", __FILE__, __LINE__);
+		return 1;
+	}
+
+	// (1) Drop the reference to the (possibly shared) callback data, and
+	// (2) free the data and its element once the last reference is gone
+	task_callback_data_t *callback_data_p = callback_p->callback_data;
+	if (atomic_fetch_sub(&(callback_data_p->refs), 1) == 1) {
+		task_set_p->release((uint8_t *)(callback_data_p->data_p));
+		task_set_p->release((uint8_t *)callback_data_p);
+	}
+
+	// (3) Free the entire callback structure
+	task_set_p->release((uint8_t *)callback_p);	
+	TRACE(TRACE_FREE, -1, 0);
+
+	return 0;
+}
+
+int init_task_set_stats (task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || task_set_p->stats != NULL) {
+		return 1;
+	}
+
+	if ((task_set_p->stats = (task_stats_t *)task_set_p->alloc(
+		sizeof(task_stats_t))) == NULL) {
+		fprintf(stderr, "%s:%d: Unable to allocate the snapshot!\n",
+			__FILE__, __LINE__);
+		return 2;
+	}
+	memset(task_set_p->stats, 0, sizeof(task_stats_t));
+	task_set_p->stats->running_task_id = -1;
+	task_set_p->stats_dirty = true;
+
+	return 0;
+}
+
+
+int publish_task_set_stats (task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || task_set_p->stats == NULL) {
+		return 1;
+	}
+
+	if (lock_task_set(task_set_p) != 0) {
+		return 2;
+	}
+
+	// Copy only if a critical section ended since the last publication
+	if (task_set_p->stats_dirty) {
+		publish_task_stats(task_set_p);
+		task_set_p->stats_dirty = false;
+	}
+
+	return release_task_set(task_set_p);
+}
+
+
+int init_task_set_timers (size_t capacity, uint64_t tick_ns,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || tick_ns == 0 || task_set_p->timers != NULL) {
+		return 1;
+	}
+
+	// Install the wheel at the current tick
+	if ((task_set_p->timers = make_timer_wheel(capacity, time_now_ns() / tick_ns,
+		task_set_p->alloc, task_set_p->release)) == NULL) {
+		fprintf(stderr, "%s:%d: Unable to allocate timer wheel!\n",
+			__FILE__, __LINE__);
+		return 2;
+	}
+
+	task_set_p->timer_tick_ns = tick_ns;
+
+	return 0;
+}
+
+
+int add_timer_for_task (off_t task_id, uint8_t prio, uint64_t delay_ns,
+	uint64_t period_ns, off_t *timer_id_p, task_set_t *task_set_p)
+{
+	return add_task_timer(TASK_TIMER_CALLBACK, task_id, prio, delay_ns,
+		period_ns, timer_id_p, task_set_p);
+}
+
+
+int cancel_timer_for_task (off_t timer_id, task_set_t *task_set_p)
+{
+	void *timer_p = NULL;
+
+	// Parameter check
+	if (task_set_p == NULL || task_set_p->timers == NULL) {
+		return 1;
+	}
+
+	// Disarm and free the descriptor
+	if (timer_wheel_cancel(timer_id, &timer_p, task_set_p->timers) != 0) {
+		return 2;
+	}
+	task_set_p->release((uint8_t *)timer_p);
+
+	return 0;
+}
+
+
+int set_task_budget (off_t task_id, uint64_t budget_ns, uint64_t period_ns,
+	task_budget_action_t action, task_set_t *task_set_p)
+{
+	task_budget_t *budget_p = NULL;
+
+	// Parameter check
+	if (task_set_p == NULL || task_set_p->timers == NULL ||
+		(budget_ns != 0 && period_ns == 0)) {
+		fprintf(stderr, "%s:%d: Bad parameters or timers disabled!\n",
+			__FILE__, __LINE__);
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	// Pool workers run without the executor metering them
+	if (budget_ns != 0 && task_is_pooled(task_set_p->tasks + task_id,
+		task_set_p)) {
+		fprintf(stderr, "%s:%d: Task %ld is served by a worker pool\n",
+			__FILE__, __LINE__, task_id);
+		return 4;
+	}
+
+	budget_p = &(task_set_p->tasks[task_id].budget);
+
+	// Drop any previous replenishment timer
+	if (budget_p->timer_id != -1) {
+		cancel_timer_for_task(budget_p->timer_id, task_set_p);
+		budget_p->timer_id = -1;
+	}
+
+	// Configure the budget (full for the first period)
+	stop_task_budget(task_id, task_set_p);
+	budget_p->budget_ns    = budget_ns;
+	budget_p->period_ns    = period_ns;
+	budget_p->remaining_ns = budget_ns;
+	budget_p->action       = action;
+	atomic_store(&(budget_p->exhausted), false);
+
+	// No budget means no replenishment
+	if (budget_ns == 0) {
+		return 0;
+	}
+
+	// Replenish at the start of every period
+	if (add_task_timer(TASK_TIMER_REPLENISH, task_id, 0, period_ns, period_ns,
+		&(budget_p->timer_id), task_set_p) != 0) {
+		budget_p->budget_ns = 0;
+		return 3;
+	}
+
+	return 0;
+}
+
+
+int charge_task_budget (off_t task_id, uint64_t used_ns,
+	task_set_t *task_set_p)
 {
-	task_callback_t *cb = (task_callback_t *)element;
-	printf("{.prio = %d, {.data_size = %zu, .data_p = %p}",
-		cb->prio, cb->callback_data->data_size, cb->callback_data->data_p); 
-}
+	task_budget_t *budget_p = NULL;
 
-/*
- *******************************************************************************
- *                            Prototype Definitions                            *
- *******************************************************************************
-*/
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		return 2;
+	}
 
+	// Nothing to charge if the task has no budget
+	if ((budget_p = &(task_set_p->tasks[task_id].budget))->budget_ns == 0) {
+		return 0;
+	}
 
-task_set_t *make_task_set (size_t len, size_t queue_depth,
- uint8_t *(*alloc)(size_t), void (*release)(uint8_t *))
+	// Mark exhaustion (if not already flagged by the budget timer)
+	budget_p->remaining_ns -= (int64_t)used_ns;
+	if (budget_p->remaining_ns <= 0 &&
+		!atomic_exchange(&(budget_p->exhausted), true)) {
+		budget_p->exhaustions++;
+	}
+
+	return 0;
+}
+
+
+int start_task_budget (off_t task_id, task_set_t *task_set_p)
 {
-	task_set_t *task_set_p = NULL;
-	task_t *tasks = NULL;
+	task_budget_t *budget_p = NULL;
+	struct timespec ts;
+	struct itimerspec spec = {0};
 
 	// Parameter check
-	if (alloc == NULL || release == NULL) {
-		return NULL;
+	if (task_set_p == NULL) {
+		return 1;
 	}
 
-	// Allocate task set
-	if ((task_set_p = (task_set_t *)alloc(sizeof(task_set_t))) == NULL) {
-		return NULL;
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		return 2;
 	}
 
-	// Allocate task array
-	if ((tasks = (task_t *)alloc(len * sizeof(task_t))) == NULL) {
-		return NULL;
+	// Nothing to meter if the task has no budget
+	budget_p = &(task_set_p->tasks[task_id].budget);
+	if (budget_p->budget_ns == 0 || budget_p->accounting) {
+		return 0;
 	}
 
-	// Configure all tasks to initial parameters
-	for (off_t i = 0; i < len; ++i) {
-		queue_t *queue_p = NULL;
+	// Create a timer on the CPU-time clock of the worker once
+	if (!budget_p->has_cpu_timer) {
+		struct sigevent sev = {0};
+		sev.sigev_notify = SIGEV_SIGNAL;
+		sev.sigev_signo  = TASK_BUDGET_SIGNAL;
+		sev.sigev_value.sival_int = (int)task_id;
 
-		// Allocate the task queue
-		if ((queue_p = make_queue(queue_depth, alloc, release)) == NULL) {
-			return NULL;
+		if (clock_getcpuclockid(task_set_p->tasks[task_id].pid,
+			&(budget_p->cpu_clock)) != 0 ||
+			timer_create(budget_p->cpu_clock, &sev, &(budget_p->cpu_timer))
+			== -1) {
+			fprintf(stderr, "%s:%d: Unable to meter the CPU time of task %ld\n",
+				__FILE__, __LINE__, task_id);
+			return 3;
 		}
-
-		tasks[i] = (task_t) {
-			.pid = -1,
-			.cb  = NULL,
-			.queue = queue_p
-		};
+		budget_p->has_cpu_timer = true;
 	}
 
-	// Configure the task set
-	task_set_p->current_running_task_id = -1;
-	task_set_p->len     = len;
-	task_set_p->tasks   = tasks;
-	task_set_p->alloc   = alloc;
-	task_set_p->release = release;
+	// Note where metering starts
+	if (clock_gettime(budget_p->cpu_clock, &ts) == -1) {
+		return 3;
+	}
+	budget_p->cpu_start_ns = time_timespec_to_ns(&ts);
+	budget_p->accounting = true;
 
-	// Initialize the shared semaphore
-	int pshared = 1; // Inter-process
-	if (sem_init(&(task_set_p->sem), pshared, 1) == -1) {
-		perror("sem_init");
+	// Expire (relative to the worker CPU time) when the budget is used up
+	if (budget_p->remaining_ns > 0) {
+		spec.it_value = time_ns_to_timespec(budget_p->remaining_ns);
+		timer_settime(budget_p->cpu_timer, 0, &spec, NULL);
 	}
 
-	return task_set_p;
+	return 0;
 }
 
 
-int get_highest_prio_task_index (task_set_t *task_set_p)
+int stop_task_budget (off_t task_id, task_set_t *task_set_p)
 {
-	int prio_task_index = -1;
-	task_callback_t *curr_data = NULL, *best_data = NULL;
+	task_budget_t *budget_p = NULL;
+	struct timespec ts;
+	struct itimerspec spec = {0};
 
 	// Parameter check
 	if (task_set_p == NULL) {
-		fprintf(stderr, "%s:%d: get_highest_prio_task has NULL param!\n",
-			__FILE__, __LINE__);
-		return -1;
+		return 1;
 	}
 
-	// Iterate across all tasks
-	for (off_t i = 0; i < task_set_p->len; ++i) {
-		task_t *task_p = task_set_p->tasks + i;
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		return 2;
+	}
 
-		// Don't consider tasks that don't have data
-		if ((curr_data = task_has_data(task_p)) == NULL) {
-			printf("Task %zu has no data -> skipping!\n",i);
-			continue;
-		}
+	// Nothing to do if not metering
+	budget_p = &(task_set_p->tasks[task_id].budget);
+	if (!budget_p->accounting) {
+		return 0;
+	}
 
-		// Set task if none is set
-		if (prio_task_index == -1) {
-			printf("Setting Task %zu as default!\n", i);
-			prio_task_index = i;
-			continue;
-		}
+	// Disarm the timer and charge the CPU time used since starting
+	timer_settime(budget_p->cpu_timer, 0, &spec, NULL);
+	budget_p->accounting = false;
+	if (clock_gettime(budget_p->cpu_clock, &ts) == 0) {
+		charge_task_budget(task_id, time_timespec_to_ns(&ts) - 
+			budget_p->cpu_start_ns, task_set_p);
+	}
 
-		// Compare current task to best
-		if (peek((void **)&best_data, (task_set_p->tasks[prio_task_index]).queue) != 0) {
-			fprintf(stderr, "%s:%d: Priority task has no data!\n",
-				__FILE__, __LINE__);
-			return -1;
-		}
+	return 0;
+}
 
-		if (curr_data->prio > best_data->prio) {
-			printf("Task %zu has a higher prio for its next data element than %u\n",
-				i, prio_task_index);
-			prio_task_index = i;
-		}
+
+int set_task_time_triggered (off_t task_id, bool time_triggered,
+	task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
 	}
 
-	return prio_task_index;
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	task_set_p->tasks[task_id].time_triggered = time_triggered;
+
+	return 0;
 }
 
-int enqueue_callback_for_task (off_t task_id, uint8_t prio, size_t data_size, void *data, 
+
+int make_server (const char *name, off_t parent_id, sched_policy_t policy,
+	uint8_t prio, uint64_t budget_ns, uint64_t period_ns, off_t *server_id_p,
 	task_set_t *task_set_p)
 {
-	task_callback_data_t *callback_data_p = NULL;
-	task_callback_t *callback_p = NULL;
-	void *data_copy = NULL;
+	task_server_t *server_p = NULL;
+	double bandwidth = 1.0, used = 0.0;
+	off_t server_id = -1;
 
-	// Verify parameters
-	if (data == NULL || task_set_p == NULL) {
-		fprintf(stderr, "%s:%d: Null parameters!\n", __FILE__, __LINE__);
+	// Parameter check
+	if (name == NULL || server_id_p == NULL || task_set_p == NULL ||
+		(budget_ns != 0 && (period_ns == 0 || budget_ns > period_ns ||
+		task_set_p->timers == NULL)) || parent_id < -1 ||
+		parent_id >= TASK_MAX_SERVERS ||
+		(parent_id != -1 && !task_set_p->servers[parent_id].in_use)) {
+		fprintf(stderr, "%s:%d: Bad parameters or timers disabled!\n",
+			__FILE__, __LINE__);
 		return 1;
 	}
 
-	// Verify parameters
-	if (task_id > task_set_p->len) {
-		fprintf(stderr, "%s:%d: Task index is out of bounds (%u > %zu)\n",
-			__FILE__, __LINE__, prio, task_set_p->len);
+	// Find a free server, and the bandwidth already given out in the parent
+	for (off_t id = TASK_MAX_SERVERS - 1; id >= 0; --id) {
+		task_server_t *sibling_p = task_set_p->servers + id;
+		if (!sibling_p->in_use) {
+			server_id = id;
+		} else if (sibling_p->parent == parent_id && sibling_p->budget_ns != 0) {
+			used += (double)sibling_p->budget_ns / sibling_p->period_ns;
+		}
+	}
+	if (server_id == -1) {
+		fprintf(stderr, "%s:%d: All servers are in use\n", __FILE__, __LINE__);
 		return 2;
 	}
 
-	// Allocate a copy of the memory provided
-	if ((data_copy = (void *)task_set_p->alloc(data_size)) == NULL) {
-		fprintf(stderr, "%s:%d: Unable to allocate copy of memory!\n",
-			__FILE__, __LINE__);
+	// Children of a limited server may only share out its bandwidth
+	for (off_t id = parent_id; id != -1; id = task_set_p->servers[id].parent) {
+		if (task_set_p->servers[id].budget_ns != 0) {
+			bandwidth = (double)task_set_p->servers[id].budget_ns /
+				task_set_p->servers[id].period_ns;
+			break;
+		}
+	}
+	if (budget_ns != 0 && used + (double)budget_ns / period_ns > bandwidth) {
+		fprintf(stderr, "%s:%d: Server bandwidth exceeded (%.3f > %.3f)\n",
+			__FILE__, __LINE__, used + (double)budget_ns / period_ns, bandwidth);
 		return 3;
-	} else {
-		memcpy(data_copy, data, data_size);
 	}
 
-	// Allocate the callback data pointer
-	if ((callback_data_p = 
-		(task_callback_data_t *)task_set_p->alloc(sizeof(task_callback_data_t))) 
-		== NULL) {
-		fprintf(stderr, "%s:%d: Unable to allocate task callback data!\n",
-			__FILE__, __LINE__);
+	server_p = task_set_p->servers + server_id;
+	*server_p = (task_server_t) {
+		.in_use          = true,
+		.parent          = parent_id,
+		.policy          = policy,
+		.prio            = prio,
+		.budget_ns       = budget_ns,
+		.period_ns       = period_ns,
+		.remaining_ns    = budget_ns,
+		.period_start_ns = time_now_ns(),
+		.timer_id        = -1
+	};
+	strncpy(server_p->name, name, TASK_SERVER_NAME_LENGTH - 1);
+
+	// Replenish at the start of every period
+	if (budget_ns != 0 && add_task_timer(TASK_TIMER_SERVER_REPLENISH,
+		server_id, 0, period_ns, period_ns, &(server_p->timer_id),
+		task_set_p) != 0) {
+		server_p->in_use = false;
 		return 4;
-	} else {
-		*callback_data_p = (task_callback_data_t){
-			.data_p = data_copy,
-			.data_size = data_size
-		};
 	}
 
-	// Allocate the callback data descriptor
-	if ((callback_p = (task_callback_t *)task_set_p->alloc(sizeof(task_callback_t))) 
-		== NULL) {
-		fprintf(stderr, "%s:%d: Unable to allocate task callback descriptor!\n",
-			__FILE__, __LINE__);
-		return 5;
+	*server_id_p = server_id;
+
+	return 0;
+}
+
+
+int set_task_server (off_t task_id, off_t server_id, task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || server_id < -1 || server_id >= TASK_MAX_SERVERS ||
+		(server_id != -1 && !task_set_p->servers[server_id].in_use)) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
+		return 2;
+	}
+
+	// Pool workers run without the executor metering them
+	if (server_id != -1 && task_is_pooled(task_set_p->tasks + task_id,
+		task_set_p)) {
+		fprintf(stderr, "%s:%d: Task %ld is served by a worker pool\n",
+			__FILE__, __LINE__, task_id);
+		return 3;
+	}
+
+	// Settle the running task with its old servers before moving it
+	if (task_id == task_set_p->current_running_task_id) {
+		uint64_t now_ns = time_now_ns();
+		charge_servers(task_id, now_ns, task_set_p);
+		task_set_p->tasks[task_id].server = server_id;
+		start_servers(task_id, now_ns, task_set_p);
 	} else {
-		*callback_p = (task_callback_t){
-			.prio = prio,
-			.callback_data = callback_data_p
-		};
+		task_set_p->tasks[task_id].server = server_id;
 	}
 
-	// Enqueue this for the given task
-	task_t *task = task_set_p->tasks + task_id;
-	if (enqueue(callback_p, task->queue) != 0) {
-		fprintf(stderr, "%s:%d: Unable to enqueue data with given task!\n",
-			__FILE__, __LINE__);
-		return 6;
+	return 0;
+}
+
+
+int show_servers (task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	for (off_t id = 0; id < TASK_MAX_SERVERS; ++id) {
+		task_server_t *server_p = task_set_p->servers + id;
+		if (!server_p->in_use) {
+			continue;
+		}
+		printf("Server %ld (%s) in %ld: %s, prio %u, budget %" PRIu64 "/%" PRIu64
+			" us, %" PRId64 " us left, %" PRIu64 " us used, %" PRIu64
+			" exhaustions, tasks:", id, server_p->name, server_p->parent,
+			sched_policy_name(server_p->policy), server_p->prio,
+			server_p->budget_ns / NS_PER_USEC, server_p->period_ns / NS_PER_USEC,
+			server_p->remaining_ns / (int64_t)NS_PER_USEC,
+			server_p->consumed_ns / NS_PER_USEC, server_p->exhaustions);
+		for (off_t i = 0; i < task_set_p->len; ++i) {
+			if (task_set_p->tasks[i].registered &&
+				task_set_p->tasks[i].server == id) {
+				printf(" %ld", i);
+			}
+		}
+		printf("\n");
 	}
 
 	return 0;
 }
 
-int dequeue_callback_for_task (off_t task_id, task_callback_t **task_callback_p_p,
+
+int set_task_criticality_level (off_t task_id, task_crit_level_t level,
+	uint64_t wcet_lo_ns, uint64_t wcet_hi_ns, task_crit_action_t action,
 	task_set_t *task_set_p)
 {
-	int err;
+	task_crit_t *crit_p = NULL;
 
 	// Parameter check
-	if (task_callback_p_p == NULL || task_set_p == NULL) {
-		fprintf(stderr, "%s:%d: Null parameters!\n", __FILE__, __LINE__);
+	if (task_set_p == NULL || (wcet_hi_ns != 0 && wcet_hi_ns < wcet_lo_ns)) {
+		fprintf(stderr, "%s:%d: Bad parameters!\n", __FILE__, __LINE__);
 		return 1;
 	}
 
 	// Task ID check
-	if (task_id > task_set_p->len) {
-		fprintf(stderr, "%s:%d: Task ID is out of bounds (%lu > %zu)\n",
-			 __FILE__, __LINE__, task_id, task_set_p->len);
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task ID is out of bounds (%ld >= %zu)\n",
+			__FILE__, __LINE__, task_id, task_set_p->len);
 		return 2;
 	}
 
-	// Locate the task
-	task_t *task = task_set_p->tasks + task_id;
+	// Pool workers run without the executor monitoring their WCET
+	if ((level == TASK_CRIT_HI || wcet_lo_ns != 0) &&
+		task_is_pooled(task_set_p->tasks + task_id, task_set_p)) {
+		fprintf(stderr, "%s:%d: Task %ld is served by a worker pool\n",
+			__FILE__, __LINE__, task_id);
+		return 3;
+	}
 
-	// Dequeue
-	if ((err = dequeue((void **)task_callback_p_p, task->queue)) != 0) {
-		fprintf(stderr, "%s:%d: Unable to dequeue (%d)!\n", __FILE__, 
-			__LINE__, err);
+	crit_p = &(task_set_p->tasks[task_id].crit);
+	crit_p->level      = level;
+	crit_p->wcet_lo_ns = wcet_lo_ns;
+	crit_p->wcet_hi_ns = wcet_hi_ns;
+	crit_p->action     = action;
+
+	return 0;
+}
+
+
+int arm_task_overrun (off_t task_id, task_set_t *task_set_p)
+{
+	task_t *task_p = NULL;
+	task_crit_t *crit_p = NULL;
+	struct timespec ts;
+	struct itimerspec spec = {0};
+	uint64_t start_ns;
+
+	// Parameter check
+	if (task_set_p == NULL) {
+		return 1;
+	}
+
+	// Task ID check
+	if (!task_id_is_valid(task_id, task_set_p)) {
+		return 2;
+	}
+
+	// Only HI-criticality tasks switch modes, and only from LO mode
+	task_p = task_set_p->tasks + task_id;
+	crit_p = &(task_p->crit);
+	if (crit_p->level != TASK_CRIT_HI || crit_p->wcet_lo_ns == 0 ||
+		task_set_p->mode == TASK_CRIT_HI) {
+		return 0;
+	}
+
+	// Create a timer on the CPU-time clock of the worker once
+	if (!crit_p->has_cpu_timer) {
+		struct sigevent sev = {0};
+		sev.sigev_notify = SIGEV_SIGNAL;
+		sev.sigev_signo  = TASK_OVERRUN_SIGNAL;
+		sev.sigev_value.sival_int = (int)task_id;
+
+		if (clock_getcpuclockid(task_p->pid, &(crit_p->cpu_clock)) != 0 ||
+			timer_create(crit_p->cpu_clock, &sev, &(crit_p->cpu_timer)) == -1) {
+			fprintf(stderr, "%s:%d: Unable to meter the CPU time of task %ld\n",
+				__FILE__, __LINE__, task_id);
+			return 3;
+		}
+		crit_p->has_cpu_timer = true;
+	}
+
+	// A resumed job keeps its start; a new one starts about now
+	if (task_p->active) {
+		start_ns = crit_p->job_cpu_start_ns;
+	} else if (clock_gettime(crit_p->cpu_clock, &ts) == 0) {
+		start_ns = time_timespec_to_ns(&ts);
+	} else {
 		return 3;
 	}
 
+	// Expire once the job used up its LO-mode WCET (preemption stops the clock)
+	spec.it_value = time_ns_to_timespec(start_ns + crit_p->wcet_lo_ns);
+	timer_settime(crit_p->cpu_timer, TIMER_ABSTIME, &spec, NULL);
+
 	return 0;
 }
 
-int free_task_callback (task_callback_t *callback_p, task_set_t *task_set_p)
+
+bool check_task_overrun (off_t task_id, task_set_t *task_set_p)
 {
+	task_t *task_p = NULL;
+	struct timespec ts;
+
 	// Parameter check
-	if (callback_p == NULL || task_set_p == NULL) {
-		fprintf(stderr, "%s:%d: Null parameters!\n", __FILE__, __LINE__);
+	if (task_set_p == NULL || !task_id_is_valid(task_id, task_set_p)) {
+		return false;
+	}
+
+	// The timer may have been armed before the job started: check (or re-arm)
+	task_p = task_set_p->tasks + task_id;
+	if (task_p->active && task_set_p->mode == TASK_CRIT_LO &&
+		clock_gettime(task_p->crit.cpu_clock, &ts) == 0) {
+		if (time_timespec_to_ns(&ts) - task_p->crit.job_cpu_start_ns >=
+			task_p->crit.wcet_lo_ns) {
+			set_criticality_mode(TASK_CRIT_HI, task_id, task_set_p);
+		} else {
+			arm_task_overrun(task_id, task_set_p);
+		}
+	}
+
+	return (task_set_p->mode == TASK_CRIT_HI);
+}
+
+
+int fire_task_set_timers (uint64_t now_ns, task_set_t *task_set_p)
+{
+	// Parameter check
+	if (task_set_p == NULL || task_set_p->timers == NULL) {
+		return -1;
+	}
+
+	return timer_wheel_advance(now_ns / task_set_p->timer_tick_ns,
+		on_timer_expiry, task_set_p, task_set_p->timers);
+}
+
+
+int get_next_timer_expiry (uint64_t *expiry_ns_p, task_set_t *task_set_p)
+{
+	uint64_t tick;
+
+	// Parameter check
+	if (expiry_ns_p == NULL || task_set_p == NULL || 
+		task_set_p->timers == NULL) {
 		return 1;
 	}
 
-	// (1) Free the copy of the data in the callback data subfield
-	task_callback_data_t *callback_data_p = callback_p->callback_data;
-	task_set_p->release((uint8_t *)(callback_data_p->data_p)); 
+	// Nothing to wait for if there are no timers
+	if (timer_wheel_next_tick(&tick, task_set_p->timers) != 0) {
+		return 2;
+	}
 
-	// (2) Free the Free the callback data element
-	task_set_p->release((uint8_t *)callback_data_p);
+	*expiry_ns_p = tick * task_set_p->timer_tick_ns;
 
-	// (3) Free the entire callback structure
-	task_set_p->release((uint8_t *)callback_p);	
+	return 0;
 }
 
+
 void show_task_set (task_set_t *task_set_p)
 {
 	if (task_set_p == NULL) {
@@ -259,13 +2779,25 @@ void show_task_set (task_set_t *task_set_p)
 	printf("task_set_t {\n"\
 		"\t.len = %zu\n"\
 		"\t.queue_depth = %zu\n"\
+		"\t.overloaded = %s (%" PRIu64 " times)\n"\
+		"\t.mode = %s (%" PRIu64 " switches to HI)\n"\
+		"\t.lock = %s (%" PRIu64 " recoveries)\n"\
 		".tasks = {\n",
 		task_set_p->len,
-		task_set_p->queue_depth);
+		task_set_p->queue_depth,
+		task_set_p->overload.overloaded ? "true" : "false",
+		task_set_p->overload.transitions,
+		(task_set_p->mode == TASK_CRIT_HI) ? "HI" : "LO",
+		task_set_p->mode_switches,
+		(task_set_p->lock_type == TASK_LOCK_PI_MUTEX) ? "pi-mutex" : "semaphore",
+		task_set_p->lock_recoveries);
 
 	for (off_t i = 0; i < task_set_p->len; ++i) {
 		task_t *t = task_set_p->tasks + i;
-		printf("\t[.pid = %d, .queue = {", t->pid);
+		printf("\t[.pid = %d, .misses = %" PRIu64 "/%" PRIu64 ", .expired = %"
+			PRIu64 ", .rejected = %" PRIu64 ", .evicted = %" PRIu64 ", .shed = %" PRIu64 ", .queue = {", t->pid,
+			t->deadlines.misses, t->deadlines.completions, t->expired,
+			t->queue->rejected, t->queue->evicted, t->shed);
 		show_queue(t->queue, show_task_element);
 		printf("}]");
 	}
@@ -282,11 +2814,16 @@ int destroy_task_set (task_set_t *task_set_p)
 		return 1;
 	}
 
-	// Destroy the shared semaphore
-	if (sem_destroy(&(task_set_p->sem)) == -1) {
+	// Destroy the shared semaphores (and mutex)
+	if (sem_destroy(&(task_set_p->sem)) == -1 ||
+		sem_destroy(&(task_set_p->lo_mode)) == -1) {
 		perror("sem_destroy");
 		return 2;
 	}
+	if (task_set_p->lock_type == TASK_LOCK_PI_MUTEX &&
+		pthread_mutex_destroy(&(task_set_p->mutex)) != 0) {
+		return 2;
+	}
 
 	// First release the task set array (user must have freed task queues)
 	for (off_t i = 0; i < task_set_p->len; ++i) {
@@ -296,6 +2833,19 @@ int destroy_task_set (task_set_t *task_set_p)
 		}
 	}
 
+	// Release the timers (and their descriptors)
+	if (task_set_p->timers != NULL) {
+		for (off_t i = 0; i < task_set_p->timers->cap; ++i) {
+			cancel_timer_for_task(i, task_set_p);
+		}
+		destroy_timer_wheel(task_set_p->timers);
+	}
+
+	// Release the snapshot
+	if (task_set_p->stats != NULL) {
+		task_set_p->release((uint8_t *)task_set_p->stats);
+	}
+
 	// Release the task array
 	task_set_p->release((uint8_t *)task_set_p->tasks);
 
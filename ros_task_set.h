@@ -20,9 +20,54 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
 #include <semaphore.h>
+#include <pthread.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
 
+#include "ros_log.h"
 #include "ros_queue.h"
+#include "ros_sched_policy.h"
+#include "ros_task_stats.h"
+#include "ros_timer_wheel.h"
+#include "ros_time.h"
+#include "ros_trace.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Signal raised (with the task ID) when a task exhausts its CPU budget
+#define TASK_BUDGET_SIGNAL           SIGUSR1
+
+// Signal raised (with the task ID) when a job may overrun its LO-mode WCET
+#define TASK_OVERRUN_SIGNAL          SIGUSR2
+
+// Number of topics tasks may subscribe to
+#define TASK_MAX_TOPICS              64
+
+// Number of callback groups
+#define TASK_MAX_GROUPS              16
+
+// Maximum number of workers backing a task in a reentrant group
+#define TASK_MAX_POOL                4
+
+// Number of chains, and tasks per chain
+#define TASK_MAX_CHAINS              8
+#define TASK_CHAIN_MAX_LEN           8
+
+// Number of reservation servers (and length of their names)
+#define TASK_MAX_SERVERS             8
+#define TASK_SERVER_NAME_LENGTH      16
+
+// Slots of the sliding window of the overload controller
+#define TASK_OVERLOAD_SLOTS          8
 
 /*
  *******************************************************************************
@@ -35,31 +80,278 @@
 typedef struct {
 	void *data_p;                         // Pointer to the data vector
 	size_t data_size;                     // Size (in bytes) of data vector
+	atomic_size_t refs;                   // Callbacks sharing the data
 } task_callback_data_t;
 
 
 // Structure: Describes a callback data element
 typedef struct {
 	uint8_t prio;                         // Callback priority
+	uint64_t arrival_ns;                  // Time of enqueue (CLOCK_MONOTONIC)
+	uint64_t dispatch_ns;                 // Time the worker took it up
+	uint64_t completion_ns;               // Time the callback returned
+	uint64_t deadline_ns;                 // Absolute deadline of the callback
+	uint64_t expiry_ns;                   // Time after which data is stale
+	off_t chain;                          // Chain of the callback (-1: none)
+	uint64_t root_arrival_ns;             // Arrival at the head of the chain
+	uint64_t slack_ns;                    // Latest start to meet the chain
+	                                      // deadline (else the deadline)
+	uint64_t cpu_start_ns;                // Worker CPU time when taken up
 	task_callback_data_t *callback_data;  // Callback data pointer
 } task_callback_t;
 
 
+// Structure: Optional attributes of an enqueued callback
+typedef struct {
+	uint64_t deadline_ns;                 // Relative deadline (0: task default)
+	uint64_t lifespan_ns;                 // Lifespan of data (0: task default)
+} task_callback_attr_t;
+
+
+// Structure: Describes the data handed to a timer callback
+typedef struct {
+	off_t timer_id;                       // ID of the expired timer
+	uint64_t expiry_ns;                   // Scheduled expiry (CLOCK_MONOTONIC)
+} task_timer_event_t;
+
+
+// Enumeration: Kinds of task timers
+typedef enum {
+	TASK_TIMER_CALLBACK = 0,              // Enqueues a callback on expiry
+	TASK_TIMER_REPLENISH,                 // Replenishes the task CPU budget
+	TASK_TIMER_SERVER_REPLENISH,          // Replenishes a server budget
+	TASK_TIMER_SERVER_DEPLETE             // Charges servers running out
+} task_timer_type_t;
+
+
+// Structure: Describes a timer that acts on a task
+typedef struct {
+	task_timer_type_t type;               // What the timer does on expiry
+	off_t task_id;                        // Task (or server) acted on
+	uint8_t prio;                         // Priority of the callbacks
+} task_timer_t;
+
+
+// Enumeration: Actions taken when a task exhausts its CPU budget
+typedef enum {
+	TASK_BUDGET_DEMOTE = 0,               // Only run when nothing else is ready
+	TASK_BUDGET_SUSPEND                   // Don't run until replenished
+} task_budget_action_t;
+
+
+// Structure: Describes the CPU budget of a task (deferrable server)
+typedef struct {
+	uint64_t budget_ns;                   // Budget per period (zero: unlimited)
+	uint64_t period_ns;                   // Replenishment period
+	int64_t remaining_ns;                 // Budget left in this period
+	task_budget_action_t action;          // Action taken on exhaustion
+	atomic_bool exhausted;                // Set when the budget runs out
+	off_t timer_id;                       // Replenishment timer (-1 if none)
+	uint64_t exhaustions;                 // Number of times the budget ran out
+	bool has_cpu_timer;                   // True once cpu_timer is created
+	timer_t cpu_timer;                    // Timer on the worker CPU-time clock
+	clockid_t cpu_clock;                  // CPU-time clock of the worker
+	bool accounting;                      // True while CPU time is metered
+	uint64_t cpu_start_ns;                // CPU time when metering started
+} task_budget_t;
+
+
+// Enumeration: Criticality levels (and modes) of mixed-criticality tasks
+typedef enum {
+	TASK_CRIT_LO = 0,                     // May be given up in HI mode
+	TASK_CRIT_HI                          // Guaranteed with its HI-mode WCET
+} task_crit_level_t;
+
+
+// Enumeration: What happens to LO-criticality tasks in HI mode
+typedef enum {
+	TASK_CRIT_SUSPEND = 0,                // Don't run until back in LO mode
+	TASK_CRIT_THROTTLE                    // Only run when nothing else is ready
+} task_crit_action_t;
+
+
+// Structure: Describes the mixed-criticality parameters of a task
+typedef struct {
+	task_crit_level_t level;              // Criticality level
+	uint64_t wcet_lo_ns;                  // LO-mode WCET (zero: unmonitored)
+	uint64_t wcet_hi_ns;                  // HI-mode WCET (zero: unbounded)
+	task_crit_action_t action;            // Treatment in HI mode (LO tasks)
+	uint64_t job_cpu_start_ns;            // Worker CPU time at the job start
+	uint64_t overruns;                    // Jobs past their LO-mode WCET
+	uint64_t hi_overruns;                 // Jobs past their HI-mode WCET
+	bool has_cpu_timer;                   // True once cpu_timer is created
+	timer_t cpu_timer;                    // Timer on the worker CPU-time clock
+	clockid_t cpu_clock;                  // CPU-time clock of the worker
+} task_crit_t;
+
+
+// Enumeration: Actions taken when a callback completes past its deadline
+typedef enum {
+	TASK_MISS_LOG = 0,                    // Only record (and report) the miss
+	TASK_MISS_SKIP_NEXT,                  // Discard the next job of the task
+	TASK_MISS_DROP_STALE                  // Discard queued jobs already late
+} task_miss_action_t;
+
+
+// Structure: Describes the deadline accounting of a task
+typedef struct {
+	task_miss_action_t action;            // Action taken on a miss
+	uint64_t completions;                 // Number of completed callbacks
+	uint64_t misses;                      // Number completed past the deadline
+	uint64_t max_lateness_ns;             // Worst completion past a deadline
+	uint64_t total_lateness_ns;           // Sum of lateness over all misses
+	uint64_t skipped;                     // Jobs discarded by the miss action
+	bool skip_next;                       // Discard the next arriving job
+} task_deadline_stats_t;
+
+
+// Enumeration: Kinds of lock guarding the task set
+typedef enum {
+	TASK_LOCK_SEMAPHORE = 0,              // Process-shared semaphore
+	TASK_LOCK_PI_MUTEX                    // Robust priority-inheritance mutex
+} task_lock_type_t;
+
+
+// Enumeration: Kinds of callback groups
+typedef enum {
+	TASK_GROUP_MUTUALLY_EXCLUSIVE = 0,    // One member callback at a time
+	TASK_GROUP_REENTRANT                  // Callbacks run in parallel
+} task_group_type_t;
+
+
+// Structure: Describes the priority aging of a task
+typedef struct {
+	uint64_t step_ns;                     // Wait per priority level (0: off)
+	uint8_t cap;                          // Highest priority aging reaches
+} task_aging_t;
+
+
+// Enumeration: How callbacks of a non-critical task are shed in overload
+typedef enum {
+	TASK_SHED_DROP = 0,                   // Refuse new callbacks
+	TASK_SHED_KEEP_LATEST                 // Keep only the newest callback
+} task_shed_action_t;
+
+
+// Structure: Describes the overload controller of a task set
+typedef struct {
+	uint64_t window_ns;                   // Sliding window (0: disabled)
+	double high_util, low_util;           // Utilization enter/leave levels
+	double high_occupancy, low_occupancy; // Queue fill enter/leave levels
+	uint8_t shed_below;                   // Criticality that is never shed
+	bool overloaded;                      // True while shedding
+	uint64_t transitions;                 // Times overload was entered
+	off_t slot;                           // Current slot of the window
+	uint64_t slot_start_ns;               // Start of the current slot
+	uint64_t busy_ns[TASK_OVERLOAD_SLOTS];  // Time a task ran, per slot
+	double occupancy[TASK_OVERLOAD_SLOTS];  // Fullest queue fill, per slot
+	uint64_t busy_since_ns;               // Start of the running stretch
+} task_overload_t;
+
+
+// Structure: Describes a callback group
+typedef struct {
+	task_group_type_t type;               // Concurrency of member callbacks
+	size_t pool_size;                     // Workers per member (reentrant)
+	size_t active;                        // Member callbacks underway
+} task_group_t;
+
+
+// Structure: Describes a reservation server: a group of tasks (and nested
+//            servers) with a CPU budget per period, scheduled by its own policy
+typedef struct {
+	char name[TASK_SERVER_NAME_LENGTH];   // Name of the server
+	bool in_use;                          // True once created
+	off_t parent;                         // Enclosing server (-1: top level)
+	sched_policy_t policy;                // Policy used among the members
+	uint8_t prio;                         // Priority within the parent
+	uint64_t budget_ns;                   // Budget per period (zero: no limit)
+	uint64_t period_ns;                   // Replenishment period
+	int64_t remaining_ns;                 // Budget left in this period
+	uint64_t period_start_ns;             // Start of the current period
+	off_t timer_id;                       // Replenishment timer (-1 if none)
+	uint64_t consumed_ns;                 // Total time charged
+	uint64_t exhaustions;                 // Number of times the budget ran out
+} task_server_t;
+
+
+// Structure: Describes a processing chain and its end-to-end latency
+typedef struct {
+	off_t tasks[TASK_CHAIN_MAX_LEN];      // Tasks of the chain (in order)
+	size_t len;                           // Number of tasks (zero: unused)
+	uint64_t deadline_ns;                 // End-to-end deadline (0: none)
+	uint64_t misses;                      // Instances past the deadline
+	histogram_t latency;                  // End-to-end latency (us)
+} task_chain_t;
+
+
 // Structure: Describes a task
 typedef struct {
 	pid_t pid;                            // PID of the owner task
 	void (*cb) (void *callback_data);     // Callback to execute on message
 	queue_t *queue;                       // Pointer to data queue
+	bool registered;                      // False if the slot is free
+	bool active;                          // True while a callback is underway
+	size_t n_active;                      // Number of callbacks underway
+	sched_key_t active_key;               // Key of the callback underway
+	uint64_t active_arrival_ns;           // Arrival of the callback underway
+	bool is_stopped;                      // True once the worker has stopped
+	task_params_t params;                 // Declared timing parameters
+	task_budget_t budget;                 // CPU budget of the task
+	task_crit_t crit;                     // Mixed-criticality parameters
+	task_deadline_stats_t deadlines;      // Deadline miss accounting
+	uint64_t lifespan_ns;                 // Default data lifespan (0: forever)
+	uint64_t expired;                     // Callbacks discarded as stale
+	uint64_t topics;                      // Bitmap of subscribed topics
+	off_t next_task;                      // Chain successor (-1 if none)
+	uint8_t next_prio;                    // Priority of forwarded callbacks
+	uint64_t fused;                       // Resumed directly by a predecessor
+	off_t chain;                          // Chain of the task (-1 if none)
+	off_t chain_hop;                      // Position of the task in it
+	off_t group;                          // Callback group (-1 if none)
+	off_t server;                         // Reservation server (-1 if none)
+	bool time_triggered;                  // Only released by a schedule table
+	pid_t pool[TASK_MAX_POOL];            // Workers of a reentrant task
+	size_t pool_len;                      // Number of pool workers
+	task_aging_t aging;                   // Priority aging of callbacks
+	uint8_t criticality;                  // Criticality (higher is kept)
+	task_shed_action_t shed_action;       // How callbacks are shed
+	uint64_t shed;                        // Callbacks shed in overload
+	bool drain;                           // Run queued callbacks back-to-back
+	uint64_t drained;                     // Callbacks run without suspending
+	uint64_t dispatches;                  // Callbacks started
+	uint64_t last_dispatch_ns;            // Start of the latest callback
+	uint64_t last_completion_ns;          // End of the latest callback
 } task_t;
 
 
 // Structure: Describes a task set
 typedef struct {
-	sem_t sem;                            // Interprocess access semaphore
+	sem_t sem;                            // Guards the scheduling state (the
+	                                      // queues and allocator lock alone)
+	pthread_mutex_t mutex;                // Replaces sem when selected
+	task_lock_type_t lock_type;           // Lock in use (see lock_task_set)
+	uint64_t lock_recoveries;             // Times a dead owner was repaired
+	sched_policy_t policy;                // Policy used to pick the next task
 	off_t current_running_task_id;        // ID of the current task (signed)
-	size_t len;                           // Number of tasks
+	size_t len;                           // Number of task slots in use
+	size_t cap;                           // Capacity of the task array
 	size_t queue_depth;                   // Depth of the task data queues
 	task_t *tasks;                        // Task element array
+	task_group_t groups[TASK_MAX_GROUPS]; // Callback groups
+	task_chain_t chains[TASK_MAX_CHAINS]; // Processing chains
+	task_overload_t overload;             // Overload controller
+	task_server_t servers[TASK_MAX_SERVERS]; // Reservation servers
+	uint64_t run_start_ns;                // Start of the running stretch
+	off_t depletion_timer_id;             // Server depletion timer (-1: none)
+	task_crit_level_t mode;               // Mixed-criticality mode
+	uint64_t mode_switches;               // Times HI mode was entered
+	sem_t lo_mode;                        // Posted for parked pool workers
+	size_t parked;                        // Pool workers waiting for LO mode
+	timer_wheel_t *timers;                // Timer wheel (NULL if no timers)
+	uint64_t timer_tick_ns;               // Duration of a timer wheel tick
+	task_stats_t *stats;                  // Published snapshot (NULL if off)
+	bool stats_dirty;                     // Changed since the last publication
 	uint8_t *(*alloc)(size_t size);       // Allocator for more memory
 	void (*release)(uint8_t *mem_ptr);    // Deallocator for memory
 } task_set_t;
@@ -83,14 +375,124 @@ task_set_t *make_task_set (size_t len, size_t queue_depth,
 
 
 /*\
- * @brief Returns the index of the highest priority task
- *        based on its data queue. 
- * @note If no task has data, then -1 is returned
+ * @brief Selects the lock guarding the task set. The robust priority-
+ *        inheritance mutex lends the priority of a blocked waiter to the
+ *        owner, and survives an owner dying inside a critical section: the
+ *        next locker repairs the task set (see lock_task_set)
+ * @note  Inheritance can't help an owner that is SIGSTOPped. The executor
+ *        only stops (or kills) workers while it holds the lock, so no worker
+ *        is stopped inside a critical section, nor in the queue or allocator
+ *        locks it takes from within one
+ * @note  Must be called before the task set is shared with other processes
+ * @param type       The kind of lock
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters, 2 if the lock is unsupported
+\*/
+int set_task_set_lock (task_lock_type_t type, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Enters the critical section of the task set. If the previous owner
+ *        of a robust mutex died holding it, then the tasks of dead workers
+ *        are repaired first: a dead running task releases the CPU and its
+ *        callbacks underway are forgotten (they are not retried)
+ * @note  The queue and allocator locks are not robust. A worker dying in one
+ *        of those (short) sections still wedges its queue
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters, 2 if the lock is unusable
+\*/
+int lock_task_set (task_set_t *task_set_p);
+
+
+/*\
+ * @brief Leaves the critical section of the task set. The snapshot (if any)
+ *        is only marked stale; publish_task_set_stats refreshes it
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters, 2 if not the owner
+\*/
+int unlock_task_set (task_set_t *task_set_p);
+
+
+/*\
+ * @brief Allocates the snapshot of the task set, which monitors read with
+ *        read_task_stats instead of taking the task set lock
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters (or if already enabled), 2
+ *         if the allocation failed
+\*/
+int init_task_set_stats (task_set_t *task_set_p);
+
+
+/*\
+ * @brief Publishes the snapshot of the task set if a critical section ended
+ *        since the last publication. Meant for the executor loop, so that
+ *        the copy stays off the paths of the workers
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success (or if nothing changed); 1 on bad parameters or
+ *         if the snapshot is off, 2 if the lock is unusable
+\*/
+int publish_task_set_stats (task_set_t *task_set_p);
+
+
+/*\
+ * @brief Returns the index of the highest priority task under the policy of
+ *        the task set. A task competes with its callback underway if it has
+ *        one, or else with the head of its data queue. Tasks that exhausted
+ *        their budget are either skipped or demoted below all other tasks.
+ *        Expired callbacks at the head of a queue are discarded first, so a
+ *        task is never woken for stale data
+ * @note If no task is eligible, then -1 is returned
  * @param task_set_p The set of tasks
  * @return Task index; -1 if not found 
 \*/
 int get_highest_prio_task_index (task_set_t *task_set_p);
 
+/*\
+ * @brief Declares the timing parameters of a task
+ * @note  The relative deadline sets the absolute deadline of each callback
+ * @param task_id    The ID of the task
+ * @param params_p   Pointer to the parameters
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_params (off_t task_id, const task_params_t *params_p,
+	task_set_t *task_set_p);
+
+/*\
+ * @brief Registers a new task at runtime. The task is only admitted if the
+ *        declared utilization of all registered tasks stays within the bound
+ *        of the scheduling policy (Liu & Layland for fixed priorities).
+ *        Admission is also rejected while a running task has no declared
+ *        parameters, since its utilization is unknown
+ * @note  The slot of a deregistered task is reused first; otherwise the task
+ *        array grows (and may move, so task pointers must not be cached)
+ * @param params_p   Timing parameters of the task (period and WCET required)
+ * @param task_id_p  Pointer at which to store the ID of the new task
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters
+ *         2: Admission rejected (utilization bound would be exceeded, or
+ *            a running task has no declared parameters)
+ *         3: Unable to allocate the task slot or its queue
+\*/
+int register_task (const task_params_t *params_p, off_t *task_id_p,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Deregisters a task, releasing its queued callbacks, timers and budget.
+ *        The chain of the task (if any) is dissolved, and chain edges into
+ *        the task are removed
+ * @note  The caller is responsible for terminating the worker of the task
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters
+ *         2: Task ID is out of bounds or not registered
+ *         3: Task has a callback underway
+\*/
+int deregister_task (off_t task_id, task_set_t *task_set_p);
+
 /*\
  * @brief Allocates and inserts callback data for a task
  * @note  The given data is copied
@@ -110,12 +512,185 @@ int get_highest_prio_task_index (task_set_t *task_set_p);
 int enqueue_callback_for_task (off_t task_id, uint8_t prio, size_t data_size, void *data, 
 	task_set_t *task_set_p);
 
+/*\
+ * @brief Like enqueue_callback_for_task, with per-callback attributes
+ * @param task_id    The ID of the task to enqueue the data with
+ * @param prio       The priority of the callback instance
+ * @param attr_p     Attributes of the callback (NULL for task defaults)
+ * @param data_size  Size of the data to copy
+ * @param data       Pointer to the data to copy
+ * @param task_set_p Pointer to the task set
+ * @return As enqueue_callback_for_task
+\*/
+int enqueue_callback_for_task_attr (off_t task_id, uint8_t prio,
+	const task_callback_attr_t *attr_p, size_t data_size, void *data,
+	task_set_t *task_set_p);
+
+/*\
+ * @brief Sets the default lifespan of callbacks enqueued for a task. Callbacks
+ *        older than their lifespan are discarded instead of executed
+ * @param task_id     The ID of the task
+ * @param lifespan_ns Lifespan of the callback data; zero never expires
+ * @param task_set_p  Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_lifespan (off_t task_id, uint64_t lifespan_ns,
+	task_set_t *task_set_p);
+
+/*\
+ * @brief Sets what happens when a callback is enqueued for a task whose queue
+ *        is full: reject the new callback or evict the oldest one (released
+ *        through the task set)
+ * @param task_id    The ID of the task
+ * @param overflow   The overflow policy of the task queue
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_overflow (off_t task_id, queue_overflow_t overflow,
+	task_set_t *task_set_p);
+
+/*\
+ * @brief Subscribes a task to (or unsubscribes it from) a topic
+ * @param task_id    The ID of the task
+ * @param topic_id   The topic (below TASK_MAX_TOPICS)
+ * @param subscribe  True to subscribe; false to unsubscribe
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int subscribe_task (off_t task_id, off_t topic_id, bool subscribe,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Publishes data on a topic: a callback is enqueued for every
+ *        subscribed task, all sharing one reference counted copy of the data
+ * @note  The shared data must be treated as read-only by the callbacks. It is
+ *        released by the free_task_callback of the last subscriber
+ * @param topic_id    The topic to publish on
+ * @param prio        The priority of the callbacks
+ * @param data_size   Size of the data to copy
+ * @param data        Pointer to the data to copy
+ * @param delivered_p Pointer at which to store the number of subscribers
+ *                    that accepted the callback (may be NULL)
+ * @param task_set_p  Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters
+ *         3: Unable to allocate copy of callback data
+ *         4: Unable to allocate callback data type
+\*/
+int publish_callback (off_t topic_id, uint8_t prio, size_t data_size,
+	void *data, size_t *delivered_p, task_set_t *task_set_p);
+
+/*\
+ * @brief Configures a callback group. Callbacks of tasks in a mutually
+ *        exclusive group never run concurrently: a member is not dispatched
+ *        while another member has a callback underway (even if preempted).
+ *        Tasks in a reentrant group are not dispatched by the executor but
+ *        served by a pool of workers, which run callbacks in parallel
+ * @param group_id   The group (below TASK_MAX_GROUPS)
+ * @param type       The kind of group
+ * @param pool_size  Workers per member task (reentrant groups; at most
+ *                   TASK_MAX_POOL)
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if the group has members
+\*/
+int set_group_type (off_t group_id, task_group_type_t type, size_t pool_size,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Moves a task into a callback group
+ * @note  The caller is responsible for matching the pool workers of the task
+ *        to task_pool_size (e.g. forking them when joining a reentrant group)
+ * @param task_id    The ID of the task
+ * @param group_id   The group (-1 to leave any group)
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters
+ *         2: Task ID is out of bounds
+ *         3: Task has a callback underway
+ *         4: Task has a budget, WCET or server but the group is reentrant
+ *            (pool workers are not metered)
+\*/
+int set_task_group (off_t task_id, off_t group_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Returns the number of pool workers a task should have
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return Pool size (zero unless the task is in a reentrant group)
+\*/
+size_t task_pool_size (off_t task_id, task_set_t *task_set_p);
+
+/*\
+ * @brief Declares a chain edge: the output of every callback of a task is
+ *        forwarded as input to the next task
+ * @param task_id      The ID of the producing task
+ * @param next_task_id The ID of the consuming task (-1 removes the edge)
+ * @param prio         The priority of the forwarded callbacks
+ * @param task_set_p   Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_chain_edge (off_t task_id, off_t next_task_id, uint8_t prio,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Forwards a completed callback along the chain edge of its task. The
+ *        descriptor and its data buffer are re-stamped and reused for the
+ *        successor (no allocation or copy), then admitted like any other
+ *        arrival (skipped or shed as enqueue_callback_for_task would). If the
+ *        successor is idle and is then the highest priority ready task, it
+ *        may be resumed directly (fused) instead of by the executor
+ * @note  To be called after complete_task_callback, in place of
+ *        free_task_callback (unless 2 is returned)
+ * @param task_id         The ID of the task that ran the callback
+ * @param callback_p      Pointer to the completed callback
+ * @param fused_task_id_p Pointer at which to store the successor if fused
+ *                        (-1 otherwise); it should be dispatched right away
+ * @param task_set_p      Pointer to the task set
+ * @return Zero if the callback was consumed; 1 on bad parameters; 2 if the
+ *         task has no chain edge (the caller still owns the callback)
+\*/
+int forward_task_output (off_t task_id, task_callback_t *callback_p,
+	off_t *fused_task_id_p, task_set_t *task_set_p);
+
+/*\
+ * @brief Defines a processing chain: chain edges are declared between
+ *        consecutive tasks, callbacks arriving at the head carry their
+ *        arrival time through every hop, and the end-to-end latency is
+ *        recorded when the last task completes. Under the chain slack policy
+ *        callbacks are ordered by the latest time they may start for the
+ *        chain to meet its deadline (given the WCETs of the remaining hops)
+ * @param tasks       The tasks of the chain, in order
+ * @param len         Number of tasks (at most TASK_CHAIN_MAX_LEN)
+ * @param deadline_ns End-to-end deadline of the chain (0: none)
+ * @param prio        Priority of the callbacks forwarded along the chain
+ * @param chain_id_p  Pointer at which to store the chain ID
+ * @param task_set_p  Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters
+ *         2: A task is out of bounds, repeated or already in a chain
+ *         3: All chains are in use
+\*/
+int define_chain (const off_t *tasks, size_t len, uint64_t deadline_ns,
+	uint8_t prio, off_t *chain_id_p, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Prints the end-to-end latency histogram of a chain
+ * @param chain_id   The ID of the chain
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters
+\*/
+int show_chain_latency (off_t chain_id, task_set_t *task_set_p);
+
 /*\
  * @brief Dequeue data element for given task
- * @note The user MUST perform the following when they no longer need the dequeued data
- *    (1) They MUST free subfield data_p in field callback_data
- *    (2) They MUST free field callback_data
- *    (3) They MUST free the callback itself
+ * @note Expired elements are discarded (and counted) rather than returned
+ * @note The user MUST release the dequeued callback with free_task_callback
+ *       when they no longer need it (the data may be shared with others)
  * @param task_id                 ID of the task to dequeue from
  * @param task_callback_data_p_p  Pointer to location to install task data pointer
  * @param task_set_p              Task set
@@ -127,8 +702,178 @@ int enqueue_callback_for_task (off_t task_id, uint8_t prio, size_t data_size, vo
 int dequeue_callback_for_task (off_t task_id, task_callback_t **task_callback_p_p,
 	task_set_t *task_set_p);
 
+/*\
+ * @brief Like dequeue_callback_for_task, for a pool worker that claimed an
+ *        element of the task queue with queue_wait_for_data
+ * @note  The claim is spent even if this fails
+ * @param task_id                 ID of the task to dequeue from
+ * @param task_callback_data_p_p  Pointer to location to install task data pointer
+ * @param task_set_p              Task set
+ * @return As dequeue_callback_for_task
+\*/
+int dequeue_claimed_callback_for_task (off_t task_id,
+	task_callback_t **task_callback_p_p, task_set_t *task_set_p);
+
+/*\
+ * @brief Checks whether HI mode suspends a task served by a worker pool. If
+ *        so, the calling worker is parked: it must call wait_for_lo_mode once
+ *        it has left the task set lock, then check again
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return True if the worker must wait
+\*/
+bool pool_task_suspended (off_t task_id, task_set_t *task_set_p);
+
+/*\
+ * @brief Blocks a parked pool worker until the task set is back in LO mode
+ * @note  Must not be called with the task set lock held
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters
+\*/
+int wait_for_lo_mode (task_set_t *task_set_p);
+
+/*\
+ * @brief Marks a dequeued callback as underway: stamps the dispatch time and
+ *        counts it against the task and its callback group
+ * @param task_id    The ID of the task that runs the callback
+ * @param callback_p Pointer to the dequeued callback
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters
+\*/
+int begin_task_callback (off_t task_id, task_callback_t *callback_p,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Records the completion of a callback: stamps the completion time,
+ *        counts a miss if it finished past its deadline and then applies
+ *        the miss action of the task. The callback is no longer underway
+ * @note  The callback must have been started with begin_task_callback
+ * @param task_id    The ID of the task that ran the callback
+ * @param callback_p Pointer to the completed callback
+ * @param task_set_p Pointer to the task set
+ * @return Zero if the deadline was met; 1 on bad parameters; 2 on a miss
+\*/
+int complete_task_callback (off_t task_id, task_callback_t *callback_p,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Changes the running task, accounting the busy time of the executor
+ * @note  All changes of current_running_task_id should go through here
+ * @param task_id    The ID of the task now running (-1 if none)
+ * @param task_set_p Pointer to the task set
+ * @return None
+\*/
+void set_running_task (off_t task_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Configures the overload controller. It tracks the share of time a
+ *        task is running and the fill of the queues enqueued to over a
+ *        sliding window. Once either passes its high level the task set is
+ *        overloaded, until both are back under their low levels. Meanwhile
+ *        callbacks of tasks with a criticality below shed_below are shed at
+ *        enqueue time
+ * @param window_ns      Length of the sliding window; zero disables control
+ * @param high_util      Utilization (0..1) at which overload is entered
+ * @param low_util       Utilization under which it may be left
+ * @param high_occupancy Queue fill (0..1) at which overload is entered
+ * @param low_occupancy  Queue fill under which it may be left
+ * @param shed_below     Tasks with a lower criticality are shed
+ * @param task_set_p     Pointer to the task set
+ * @return Zero on success; 1 on bad parameters
+\*/
+int set_overload_control (uint64_t window_ns, double high_util,
+	double low_util, double high_occupancy, double low_occupancy,
+	uint8_t shed_below, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Updates the overload controller
+ * @param util_p      Pointer at which to store the utilization (may be NULL)
+ * @param occupancy_p Pointer at which to store the queue fill (may be NULL)
+ * @param task_set_p  Pointer to the task set
+ * @return True if the task set is overloaded
+\*/
+bool update_overload (double *util_p, double *occupancy_p,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Prints the state of the overload controller and callbacks shed
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters
+\*/
+int show_overload (task_set_t *task_set_p);
+
+
+/*\
+ * @brief Sets the criticality of a task and how it is shed in overload
+ * @param task_id     The ID of the task
+ * @param criticality The criticality (compared with shed_below)
+ * @param action      Drop new callbacks, or keep only the newest one
+ * @param task_set_p  Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_criticality (off_t task_id, uint8_t criticality,
+	task_shed_action_t action, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Sets the action taken when a callback of a task misses its deadline
+ * @param task_id    The ID of the task
+ * @param action     The miss action
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_miss_action (off_t task_id, task_miss_action_t action,
+	task_set_t *task_set_p);
+
+/*\
+ * @brief Configures priority aging for a task. While a callback of the task
+ *        waits (queued or preempted), its effective priority under the fixed
+ *        priority policy rises one level per step, up to the cap. This is
+ *        computed from the arrival time when the task is considered, so it
+ *        costs O(1) per decision and needs no periodic rescan
+ * @param task_id    The ID of the task
+ * @param step_ns    Waiting time per priority level; zero disables aging
+ * @param cap        Highest effective priority aging may reach
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_aging (off_t task_id, uint64_t step_ns, uint8_t cap,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Enables or disables drain mode for a task. In drain mode a worker
+ *        keeps running queued callbacks for as long as its task remains the
+ *        highest priority ready task, instead of suspending after each one
+ * @param task_id    The ID of the task
+ * @param drain      True to enable drain mode
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_drain (off_t task_id, bool drain, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Returns true if a worker that just completed a callback may take up
+ *        the next one without suspending: the task drains, and is still the
+ *        highest priority ready task (the check for preemption)
+ * @note  Counts the callback as drained if so
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return True if the worker should continue
+\*/
+bool task_may_continue (off_t task_id, task_set_t *task_set_p);
+
 /*\
  * @brief Releases memory associated with a callback
+ * @note  Workers must hold the task set lock: the executor only stops or
+ *        kills workers under it, and so never while they hold the allocator
+ *        lock. The shared data is released by whoever drops the last reference
  * @param callback_p Pointer to callback data structure
  * @param task_set_p Pointer to the task set
  * @return Zero on success; 1 on bad parameters
@@ -136,6 +881,219 @@ int dequeue_callback_for_task (off_t task_id, task_callback_t **task_callback_p_
 int free_task_callback (task_callback_t *callback_p, task_set_t *task_set_p);
 
 
+/*\
+ * @brief Enables timers for the task set by installing a timer wheel
+ * @note  Wheel ticks are aligned to CLOCK_MONOTONIC
+ * @param capacity   Maximum number of concurrent timers
+ * @param tick_ns    Resolution (in nanoseconds) of the timers
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters, or timers are already enabled
+ *         2: Unable to allocate the timer wheel
+\*/
+int init_task_set_timers (size_t capacity, uint64_t tick_ns,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Creates a timer which enqueues a callback for a task on expiry
+ * @note  The callback data is a task_timer_event_t
+ * @param task_id    The ID of the task to enqueue callbacks for
+ * @param prio       The priority of the enqueued callbacks
+ * @param delay_ns   Time until the first expiry
+ * @param period_ns  Period of the timer; zero for a one-shot timer
+ * @param timer_id_p Pointer at which to store the timer ID (may be NULL)
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters, or timers are not enabled
+ *         2: Task ID is out of bounds
+ *         3: Unable to allocate the timer descriptor
+ *         4: Timer wheel is at capacity
+\*/
+int add_timer_for_task (off_t task_id, uint8_t prio, uint64_t delay_ns,
+	uint64_t period_ns, off_t *timer_id_p, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Cancels a timer created with add_timer_for_task
+ * @param timer_id   The ID of the timer
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if no such timer
+\*/
+int cancel_timer_for_task (off_t timer_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Assigns a CPU budget to a task, replenished at the start of every
+ *        period (unused budget is not carried over)
+ * @param task_id    The ID of the task
+ * @param budget_ns  CPU time per period; zero removes the budget
+ * @param period_ns  Replenishment period
+ * @param action     Action taken when the budget is exhausted
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters, or timers are not enabled
+ *         2: Task ID is out of bounds
+ *         3: Unable to create the replenishment timer
+ *         4: Task is served by a worker pool
+\*/
+int set_task_budget (off_t task_id, uint64_t budget_ns, uint64_t period_ns,
+	task_budget_action_t action, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Charges consumed CPU time against the budget of a task
+ * @param task_id    The ID of the task
+ * @param used_ns    CPU time consumed
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int charge_task_budget (off_t task_id, uint64_t used_ns,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Starts metering the CPU-time clock of the worker of a task. A POSIX
+ *        timer on that clock raises TASK_BUDGET_SIGNAL (with the task ID as
+ *        value) in the calling process once the remaining budget is used up
+ * @note  To be called by the executor whenever it resumes the worker
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; otherwise:
+ *         1: Bad parameters
+ *         2: Task ID is out of bounds
+ *         3: Unable to access the CPU-time clock of the worker
+\*/
+int start_task_budget (off_t task_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Stops metering the worker of a task and charges the CPU time used
+ * @note  To be called by the executor whenever the worker stops
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int stop_task_budget (off_t task_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Makes a task time-triggered: it is never picked by the priority
+ *        scan, and only runs when the executor releases it from a schedule
+ *        table
+ * @param task_id        The ID of the task
+ * @param time_triggered True to leave the task to the schedule table
+ * @param task_set_p     Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds
+\*/
+int set_task_time_triggered (off_t task_id, bool time_triggered,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Creates a reservation server. Its members (tasks and servers) are
+ *        picked among themselves by its own policy, and the server competes
+ *        within its parent on their behalf: with its priority, and with the
+ *        end of its period as deadline. Time its members run is charged to
+ *        it (and to its ancestors); once exhausted none of them run until
+ *        the next replenishment
+ * @param name        Name of the server
+ * @param parent_id   Enclosing server (-1: top level)
+ * @param policy      Policy used among the members
+ * @param prio        Priority of the server within its parent
+ * @param budget_ns   Budget per period; zero groups tasks without a limit
+ * @param period_ns   Replenishment period
+ * @param server_id_p Pointer at which to store the server ID
+ * @param task_set_p  Pointer to the task set
+ * @return Zero on success; 1 on bad parameters or timers disabled;
+ *         2 if all servers are in use; 3 if the bandwidth of the parent
+ *         (or of the CPU) would be exceeded; 4 if no timer is available
+\*/
+int make_server (const char *name, off_t parent_id, sched_policy_t policy,
+	uint8_t prio, uint64_t budget_ns, uint64_t period_ns, off_t *server_id_p,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Moves a task into a reservation server
+ * @param task_id    The ID of the task
+ * @param server_id  The ID of the server (-1: none)
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds;
+ *         3 if the task is served by a worker pool
+\*/
+int set_task_server (off_t task_id, off_t server_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Prints the reservation servers and their members
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters
+\*/
+int show_servers (task_set_t *task_set_p);
+
+
+/*\
+ * @brief Sets the criticality level and the LO/HI-mode WCETs of a task. The
+ *        set starts in LO mode and switches to HI mode as soon as a job of a
+ *        HI-criticality task runs past its LO-mode WCET. In HI mode the
+ *        LO-criticality tasks are suspended or throttled, until the set next
+ *        goes idle
+ * @param task_id    The ID of the task
+ * @param level      The criticality level
+ * @param wcet_lo_ns WCET assumed in LO mode (zero: never monitored)
+ * @param wcet_hi_ns WCET assumed in HI mode (zero: unbounded)
+ * @param action     Whether a LO-criticality task is suspended or throttled
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds;
+ *         3 if a HI level or WCET is given to a task served by a worker pool
+\*/
+int set_task_criticality_level (off_t task_id, task_crit_level_t level,
+	uint64_t wcet_lo_ns, uint64_t wcet_hi_ns, task_crit_action_t action,
+	task_set_t *task_set_p);
+
+
+/*\
+ * @brief Arms a timer on the CPU-time clock of the worker of a HI-criticality
+ *        task that raises TASK_OVERRUN_SIGNAL (with the task ID as value) in
+ *        the calling process once its job reaches the LO-mode WCET
+ * @note  To be called by the executor whenever it resumes the worker
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if task ID is out of bounds;
+ *         3 if the CPU-time clock of the worker can't be metered
+\*/
+int arm_task_overrun (off_t task_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Checks whether the job of a task ran past its LO-mode WCET on
+ *        receiving TASK_OVERRUN_SIGNAL, and if so enters HI mode
+ * @param task_id    The ID of the task
+ * @param task_set_p Pointer to the task set
+ * @return True if the set is in HI mode
+\*/
+bool check_task_overrun (off_t task_id, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Enqueues callbacks for all timers that expired up to the given time
+ * @param now_ns     Current time (CLOCK_MONOTONIC)
+ * @param task_set_p Pointer to the task set
+ * @return Number of expired timers; -1 on bad parameters
+\*/
+int fire_task_set_timers (uint64_t now_ns, task_set_t *task_set_p);
+
+
+/*\
+ * @brief Returns the time at which fire_task_set_timers must next be called
+ * @param expiry_ns_p Pointer at which to store the time (CLOCK_MONOTONIC)
+ * @param task_set_p  Pointer to the task set
+ * @return Zero on success; 1 on bad parameters; 2 if there are no timers
+\*/
+int get_next_timer_expiry (uint64_t *expiry_ns_p, task_set_t *task_set_p);
+
+
 /*\
  * @brief Displays the task set
  * @param task_set_p Pointer to task set
@@ -148,7 +1106,7 @@ void show_task_set (task_set_t *task_set_p);
  * @brief Destroys a task set by releasing allocated memory back to underlying
  *        allocator
  * @param task_set_p Pointer to task set
- * @return Zeron on success; 1 on bad parameters, 2 if unable to destroy semaphore
+ * @return Zeron on success; 1 on bad parameters, 2 if unable to destroy the lock
 \*/
 int destroy_task_set (task_set_t *task_set_p);
 
@@ -6,7 +6,8 @@
 #include "ros_queue.h"
 #include "ros_static_allocator.h"
 
-#define MEM_SIZE 8192
+// Room for the task set (its servers and chain histograms are inline)
+#define MEM_SIZE 65536
 
 // Memory (shared)
 uint8_t g_memory[MEM_SIZE];
@@ -43,7 +44,11 @@ int main (void)
 	g_allocator = install_static_allocator(g_memory, MEM_SIZE);
 
 	// Setup task set
-	g_task_set = make_task_set(n_tasks, queue_depth, alloc, release);
+	if ((g_task_set = make_task_set(n_tasks, queue_depth, alloc, release))
+		== NULL) {
+		fprintf(stderr, "Unable to make the task set!\n");
+		return EXIT_FAILURE;
+	}
 
 	// Show task set
 	show_task_set(g_task_set);
@@ -55,7 +60,9 @@ int main (void)
 	task_callback_t *cb_p = NULL;
 	do {
 		printf("Specify task for operation: ");
-		scanf("%d", &task_id);
+		if (scanf("%d", &task_id) != 1) {
+			break;
+		}
 		printf("\nInput captured: %d\n", task_id);
 		if (task_id > n_tasks) {
 			printf("\nThat task index is out of bounds!\n");
@@ -63,11 +70,15 @@ int main (void)
 		}
 
 		printf("Press (s) to enqueue a string, or (d) to dequeue a string: ");
-		scanf("\n%c", &selection);
+		if (scanf("\n%c", &selection) != 1) {
+			break;
+		}
 		switch (selection) {
 			case 's': {
 				printf("\nOkay, enter your string: ");
-				scanf("%s", string_data);
+				if (scanf("%255s", string_data) != 1) {
+					continue;
+				}
 				printf("\nInput captured: \"%s\"\n", string_data);
 
 				// Insert data for specified task
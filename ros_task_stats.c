@@ -0,0 +1,229 @@
+#include "ros_task_stats.h"
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+void task_stats_write_begin (task_stats_t *stats_p)
+{
+	uint64_t seq = atomic_load_explicit(&(stats_p->seq), memory_order_relaxed);
+
+	// Odd: readers that overlap any of the stores below retry
+	atomic_store_explicit(&(stats_p->seq), seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+}
+
+
+void task_stats_write_end (task_stats_t *stats_p)
+{
+	uint64_t seq = atomic_load_explicit(&(stats_p->seq), memory_order_relaxed);
+
+	// Even again: the stores above are visible before the new version
+	atomic_store_explicit(&(stats_p->seq), seq + 1, memory_order_release);
+}
+
+
+int read_task_stats (task_stats_t *copy_p, const task_stats_t *stats_p)
+{
+	uint64_t before, after;
+	size_t len;
+
+	// Parameter check
+	if (copy_p == NULL || stats_p == NULL) {
+		return 1;
+	}
+
+	for (off_t i = 0; i < TASK_STATS_MAX_RETRIES; ++i) {
+
+		// A write is underway
+		if ((before = atomic_load_explicit(&(stats_p->seq),
+			memory_order_acquire)) & 1) {
+			continue;
+		}
+
+		// Copy the header, then only the entries in use
+		memcpy((uint8_t *)copy_p + sizeof(copy_p->seq),
+			(const uint8_t *)stats_p + sizeof(stats_p->seq),
+			offsetof(task_stats_t, tasks) - sizeof(stats_p->seq));
+		len = (copy_p->len > TASK_STATS_MAX_TASKS) ? TASK_STATS_MAX_TASKS :
+			copy_p->len;
+		memcpy(copy_p->tasks, stats_p->tasks, len * sizeof(task_stats_entry_t));
+
+		// Keep the copy only if no write started meanwhile
+		atomic_thread_fence(memory_order_acquire);
+		after = atomic_load_explicit(&(stats_p->seq), memory_order_relaxed);
+		if (before == after) {
+			atomic_store_explicit(&(copy_p->seq), before, memory_order_relaxed);
+			copy_p->len = len;
+			return 0;
+		}
+	}
+
+	return 2;
+}
+
+
+void task_stats_record_latency (off_t task_id, uint64_t queueing_ns,
+	uint64_t execution_ns, uint64_t response_ns, task_stats_t *stats_p)
+{
+	histogram_t *latency = NULL;
+
+	if (stats_p == NULL || task_id < 0 || task_id >= TASK_STATS_MAX_TASKS) {
+		return;
+	}
+
+	latency = stats_p->latency[task_id];
+	histogram_record(queueing_ns / 1000, latency + TASK_LATENCY_QUEUEING);
+	histogram_record(execution_ns / 1000, latency + TASK_LATENCY_EXECUTION);
+	histogram_record(response_ns / 1000, latency + TASK_LATENCY_RESPONSE);
+}
+
+
+int task_stats_latency_percentile (off_t task_id, task_latency_t latency,
+	double q, uint64_t *latency_ns_p, const task_stats_t *stats_p)
+{
+	uint64_t latency_us;
+	int err;
+
+	// Parameter check
+	if (latency_ns_p == NULL || stats_p == NULL || task_id < 0 ||
+		task_id >= TASK_STATS_MAX_TASKS || latency >= TASK_LATENCY_COUNT) {
+		return 1;
+	}
+
+	if ((err = histogram_percentile(q, &latency_us,
+		&(stats_p->latency[task_id][latency]))) != 0) {
+		return err;
+	}
+	*latency_ns_p = latency_us * 1000;
+
+	return 0;
+}
+
+
+int show_task_latency (off_t task_id, const task_stats_t *stats_p)
+{
+	static const char *names[TASK_LATENCY_COUNT] = {
+		[TASK_LATENCY_QUEUEING]  = "queueing",
+		[TASK_LATENCY_EXECUTION] = "execution",
+		[TASK_LATENCY_RESPONSE]  = "response"
+	};
+
+	// Parameter check
+	if (stats_p == NULL || task_id < 0 || task_id >= TASK_STATS_MAX_TASKS) {
+		return 1;
+	}
+
+	printf("Task %ld latencies:\n", task_id);
+	for (off_t l = 0; l < TASK_LATENCY_COUNT; ++l) {
+		show_histogram(names[l], "us", &(stats_p->latency[task_id][l]));
+	}
+
+	return 0;
+}
+
+
+int reset_task_latency (off_t task_id, task_stats_t *stats_p)
+{
+	off_t first = task_id, last = task_id;
+
+	// Parameter check
+	if (stats_p == NULL || task_id < -1 || task_id >= TASK_STATS_MAX_TASKS) {
+		return 1;
+	}
+
+	if (task_id == -1) {
+		first = 0;
+		last = TASK_STATS_MAX_TASKS - 1;
+	}
+
+	for (off_t i = first; i <= last; ++i) {
+		for (off_t l = 0; l < TASK_LATENCY_COUNT; ++l) {
+			histogram_reset(&(stats_p->latency[i][l]));
+		}
+	}
+
+	return 0;
+}
+
+
+void task_stats_record_perf (off_t task_id, const perf_sample_t *delta_p,
+	task_stats_t *stats_p)
+{
+	if (stats_p == NULL || delta_p == NULL || task_id < 0 ||
+		task_id >= TASK_STATS_MAX_TASKS) {
+		return;
+	}
+
+	for (off_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+		atomic_fetch_add_explicit(&(stats_p->perf[task_id][c]),
+			delta_p->counts[c], memory_order_relaxed);
+	}
+	atomic_fetch_add_explicit(&(stats_p->perf_samples[task_id]), 1,
+		memory_order_relaxed);
+}
+
+
+int task_stats_perf_mean (off_t task_id, perf_sample_t *mean_p,
+	const task_stats_t *stats_p)
+{
+	uint64_t samples;
+
+	// Parameter check
+	if (mean_p == NULL || stats_p == NULL || task_id < 0 ||
+		task_id >= TASK_STATS_MAX_TASKS) {
+		return 1;
+	}
+
+	// Totals may be a callback apart from the count; fine for averages
+	samples = atomic_load_explicit(
+		(atomic_uint_least64_t *)&(stats_p->perf_samples[task_id]),
+		memory_order_relaxed);
+	if (samples == 0) {
+		return 2;
+	}
+
+	for (off_t c = 0; c < PERF_COUNTER_COUNT; ++c) {
+		mean_p->counts[c] = atomic_load_explicit(
+			(atomic_uint_least64_t *)&(stats_p->perf[task_id][c]),
+			memory_order_relaxed) / samples;
+	}
+
+	return 0;
+}
+
+
+void show_task_stats (const task_stats_t *stats_p)
+{
+	if (stats_p == NULL) {
+		printf("<Null>\n");
+		return;
+	}
+
+	printf("task_stats_t {\n"\
+		"\t.publications = %" PRIu64 "\n"\
+		"\t.running = %ld\n"\
+		"\t.overloaded = %s\n"\
+		"\t.mode = %s\n"\
+		".tasks = {\n",
+		stats_p->publications,
+		stats_p->running_task_id,
+		stats_p->overloaded ? "true" : "false",
+		stats_p->hi_mode ? "HI" : "LO");
+
+	for (off_t i = 0; i < stats_p->len; ++i) {
+		const task_stats_entry_t *t = stats_p->tasks + i;
+		if (!t->registered) {
+			continue;
+		}
+		printf("\t[%ld: .pid = %d, .queue = %zu/%zu, .dispatches = %" PRIu64
+			", .misses = %" PRIu64 "/%" PRIu64 ", .last_dispatch_ns = %" PRIu64
+			"]\n", i, t->pid, t->queue_len, t->queue_cap, t->dispatches,
+			t->misses, t->completions, t->last_dispatch_ns);
+	}
+
+	printf("\t}\n}\n");
+}
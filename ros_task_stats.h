@@ -0,0 +1,216 @@
+#if !defined(ROS_TASK_STATS_H)
+#define ROS_TASK_STATS_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 10/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Seqlock-versioned snapshot of the scheduler state. The (single) writer     *
+ *  publishes under the task set lock; readers copy it out without locking     *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <sys/types.h>
+
+#include "ros_histogram.h"
+#include "ros_perf.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Number of tasks a snapshot describes
+#define TASK_STATS_MAX_TASKS         64
+
+// Attempts a reader makes before giving up on a busy writer
+#define TASK_STATS_MAX_RETRIES       1000
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Enumeration: Latencies of a callback (histograms in microseconds)
+typedef enum {
+	TASK_LATENCY_QUEUEING = 0,          // Arrival to start
+	TASK_LATENCY_EXECUTION,             // CPU time of the callback
+	TASK_LATENCY_RESPONSE,              // Arrival to completion
+	TASK_LATENCY_COUNT
+} task_latency_t;
+
+
+// Structure: Published state of a single task
+typedef struct {
+	pid_t pid;                          // PID of the worker (-1 if none)
+	bool registered;                    // False if the slot is free
+	bool active;                        // True while a callback is underway
+	bool stopped;                       // True once the worker has stopped
+	size_t queue_len;                   // Callbacks waiting
+	size_t queue_cap;                   // Depth of the queue
+	uint64_t dispatches;                // Callbacks started
+	uint64_t completions;               // Callbacks completed
+	uint64_t misses;                    // Deadline misses
+	uint64_t expired;                   // Callbacks discarded as stale
+	uint64_t rejected;                  // Callbacks refused (queue full)
+	uint64_t evicted;                   // Callbacks evicted (queue full)
+	uint64_t shed;                      // Callbacks shed in overload
+	uint64_t last_dispatch_ns;          // Start of the latest callback
+	uint64_t last_completion_ns;        // End of the latest callback
+} task_stats_entry_t;
+
+
+// Structure: Seqlock-versioned snapshot of the task set
+typedef struct {
+	atomic_uint_least64_t seq;          // Odd while a write is underway
+	uint64_t published_ns;              // Time of the latest publication
+	uint64_t publications;              // Number of publications
+	off_t running_task_id;              // Task holding the CPU (-1 if none)
+	bool overloaded;                    // True while shedding
+	bool hi_mode;                       // True in HI-criticality mode
+	uint64_t mode_switches;             // Times HI mode was entered
+	uint64_t overload_transitions;      // Times overload was entered
+	size_t len;                         // Task entries in use
+	size_t dropped;                     // Tasks beyond the entries
+	task_stats_entry_t tasks[TASK_STATS_MAX_TASKS];
+
+	// Callback latency histograms (counted atomically, outside the seqlock)
+	histogram_t latency[TASK_STATS_MAX_TASKS][TASK_LATENCY_COUNT];
+
+	// Performance counter totals of callbacks (as above; zero if off)
+	atomic_uint_least64_t perf_samples[TASK_STATS_MAX_TASKS];
+	atomic_uint_least64_t perf[TASK_STATS_MAX_TASKS][PERF_COUNTER_COUNT];
+} task_stats_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Starts an update of the snapshot (making it odd, so readers retry)
+ * @note  Writers must be serialized by the caller
+ * @param stats_p Pointer to the snapshot
+ * @return None
+\*/
+void task_stats_write_begin (task_stats_t *stats_p);
+
+
+/*\
+ * @brief Completes an update of the snapshot
+ * @param stats_p Pointer to the snapshot
+ * @return None
+\*/
+void task_stats_write_end (task_stats_t *stats_p);
+
+
+/*\
+ * @brief Copies out a consistent snapshot without blocking the writer. A
+ *        copy that overlapped a write is discarded and taken again
+ * @param copy_p  Where to copy the snapshot to
+ * @param stats_p Pointer to the (shared) snapshot
+ * @return Zero on success; 1 on bad parameters, 2 if the writer kept the
+ *         snapshot busy for TASK_STATS_MAX_RETRIES attempts
+\*/
+int read_task_stats (task_stats_t *copy_p, const task_stats_t *stats_p);
+
+
+/*\
+ * @brief Counts the latencies of a callback in the histograms of its task
+ * @note  Safe to call from any process without a lock
+ * @param task_id      The ID of the task
+ * @param queueing_ns  Time from the arrival to the start of the callback
+ * @param execution_ns CPU time of the callback
+ * @param response_ns  Time from the arrival to the completion
+ * @param stats_p      Pointer to the (shared) snapshot
+ * @return None
+\*/
+void task_stats_record_latency (off_t task_id, uint64_t queueing_ns,
+	uint64_t execution_ns, uint64_t response_ns, task_stats_t *stats_p);
+
+
+/*\
+ * @brief Returns a percentile of a latency of a task, rounded up to the
+ *        bound of its histogram bucket
+ * @param task_id      The ID of the task
+ * @param latency      The latency
+ * @param q            The percentile (between 0 and 100)
+ * @param latency_ns_p Where to store the latency
+ * @param stats_p      Pointer to the (shared) snapshot
+ * @return Zero on success; 1 on bad parameters, 2 if there are no samples
+\*/
+int task_stats_latency_percentile (off_t task_id, task_latency_t latency,
+	double q, uint64_t *latency_ns_p, const task_stats_t *stats_p);
+
+
+/*\
+ * @brief Displays the latency histograms of a task
+ * @param task_id The ID of the task
+ * @param stats_p Pointer to the (shared) snapshot
+ * @return Zero on success; 1 on bad parameters
+\*/
+int show_task_latency (off_t task_id, const task_stats_t *stats_p);
+
+
+/*\
+ * @brief Empties the latency histograms of a task
+ * @param task_id The ID of the task (-1: all tasks)
+ * @param stats_p Pointer to the (shared) snapshot
+ * @return Zero on success; 1 on bad parameters
+\*/
+int reset_task_latency (off_t task_id, task_stats_t *stats_p);
+
+
+/*\
+ * @brief Adds the performance counters of a callback to its task
+ * @note  Safe to call from any process without a lock
+ * @param task_id  The ID of the task
+ * @param delta_p  The counters of the callback
+ * @param stats_p  Pointer to the (shared) snapshot
+ * @return None
+\*/
+void task_stats_record_perf (off_t task_id, const perf_sample_t *delta_p,
+	task_stats_t *stats_p);
+
+
+/*\
+ * @brief Returns the average performance counters of the callbacks of a
+ *        task
+ * @param task_id  The ID of the task
+ * @param mean_p   Where to store the averages
+ * @param stats_p  Pointer to the (shared) snapshot
+ * @return Zero on success; 1 on bad parameters, 2 if there are no samples
+\*/
+int task_stats_perf_mean (off_t task_id, perf_sample_t *mean_p,
+	const task_stats_t *stats_p);
+
+
+/*\
+ * @brief Displays a snapshot
+ * @param stats_p Pointer to a snapshot (copied out by read_task_stats)
+ * @return None
+\*/
+void show_task_stats (const task_stats_t *stats_p);
+
+
+#endif
@@ -0,0 +1,28 @@
+#include "ros_time.h"
+
+
+uint64_t time_now_ns (void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
+		return 0;
+	}
+
+	return time_timespec_to_ns(&ts);
+}
+
+
+struct timespec time_ns_to_timespec (uint64_t ns)
+{
+	return (struct timespec) {
+		.tv_sec  = (time_t)(ns / NS_PER_SEC),
+		.tv_nsec = (long)(ns % NS_PER_SEC)
+	};
+}
+
+
+uint64_t time_timespec_to_ns (const struct timespec *ts)
+{
+	return (uint64_t)ts->tv_sec * NS_PER_SEC + (uint64_t)ts->tv_nsec;
+}
@@ -0,0 +1,68 @@
+#if !defined(ROS_TIME_H)
+#define ROS_TIME_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 03/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Monotonic time helpers (compile with -lrt)                                 *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <inttypes.h>
+#include <time.h>
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Nanoseconds per second
+#define NS_PER_SEC                   UINT64_C(1000000000)
+
+// Nanoseconds per millisecond
+#define NS_PER_MSEC                  UINT64_C(1000000)
+
+// Nanoseconds per microsecond
+#define NS_PER_USEC                  UINT64_C(1000)
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Returns the current CLOCK_MONOTONIC time
+ * @return Time in nanoseconds
+\*/
+uint64_t time_now_ns (void);
+
+
+/*\
+ * @brief Converts a nanosecond count into a timespec
+ * @param ns Time in nanoseconds
+ * @return Equivalent timespec
+\*/
+struct timespec time_ns_to_timespec (uint64_t ns);
+
+
+/*\
+ * @brief Converts a timespec into a nanosecond count
+ * @param ts Pointer to timespec
+ * @return Time in nanoseconds
+\*/
+uint64_t time_timespec_to_ns (const struct timespec *ts);
+
+
+#endif
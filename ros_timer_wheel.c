@@ -0,0 +1,341 @@
+#include "ros_timer_wheel.h"
+
+/*
+ *******************************************************************************
+ *                        Internal Function Definitions                        *
+ *******************************************************************************
+*/
+
+
+// Places an armed timer in the slot matching its expiry
+static void wheel_insert (wheel_timer_t *timer_p, timer_wheel_t *wheel_p)
+{
+	uint64_t expiry = timer_p->expiry, delta;
+	const uint64_t range = 1ULL << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS);
+	off_t level = 0;
+
+	// Expiries in the past are placed in the next tick to process
+	if (expiry < wheel_p->tick) {
+		expiry = wheel_p->tick;
+	}
+
+	// Expiries beyond the range wait in the outermost level (re-cascaded later)
+	if ((delta = expiry - wheel_p->tick) >= range) {
+		expiry = wheel_p->tick + range - 1;
+		delta  = range - 1;
+	}
+
+	// Find the lowest level that spans the delta
+	while (delta >= (1ULL << (TIMER_WHEEL_SLOT_BITS * (level + 1)))) {
+		level++;
+	}
+
+	// Slots are indexed by the expiry bits of the level
+	off_t slot = (expiry >> (TIMER_WHEEL_SLOT_BITS * level)) &
+		TIMER_WHEEL_SLOT_MASK;
+
+	// Push onto the slot list
+	timer_p->level = level;
+	timer_p->slot  = slot;
+	timer_p->prev  = NULL;
+	timer_p->next  = wheel_p->slots[level][slot];
+	if (timer_p->next != NULL) {
+		timer_p->next->prev = timer_p;
+	}
+	wheel_p->slots[level][slot] = timer_p;
+	wheel_p->occupied[level] |= (1ULL << slot);
+}
+
+// Unlinks an armed timer from its slot
+static void wheel_remove (wheel_timer_t *timer_p, timer_wheel_t *wheel_p)
+{
+	off_t level = timer_p->level, slot = timer_p->slot;
+
+	if (timer_p->prev != NULL) {
+		timer_p->prev->next = timer_p->next;
+	} else {
+		wheel_p->slots[level][slot] = timer_p->next;
+	}
+
+	if (timer_p->next != NULL) {
+		timer_p->next->prev = timer_p->prev;
+	}
+
+	if (wheel_p->slots[level][slot] == NULL) {
+		wheel_p->occupied[level] &= ~(1ULL << slot);
+	}
+
+	timer_p->next = timer_p->prev = NULL;
+}
+
+// Detaches and returns the entire list of a slot
+static wheel_timer_t *wheel_detach (off_t level, off_t slot,
+	timer_wheel_t *wheel_p)
+{
+	wheel_timer_t *list = wheel_p->slots[level][slot];
+
+	wheel_p->slots[level][slot] = NULL;
+	wheel_p->occupied[level] &= ~(1ULL << slot);
+
+	return list;
+}
+
+// Returns a timer to the free list of the pool
+static void wheel_free (wheel_timer_t *timer_p, timer_wheel_t *wheel_p)
+{
+	timer_p->armed = false;
+	timer_p->data  = NULL;
+	timer_p->prev  = NULL;
+	timer_p->next  = wheel_p->free_list;
+	wheel_p->free_list = timer_p;
+	wheel_p->len--;
+}
+
+// Moves the timers of the current slot of each wrapped level down the wheel
+static void wheel_cascade (timer_wheel_t *wheel_p)
+{
+	for (off_t level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+		off_t slot = (wheel_p->tick >> (TIMER_WHEEL_SLOT_BITS * level)) &
+			TIMER_WHEEL_SLOT_MASK;
+		wheel_timer_t *timer_p = wheel_detach(level, slot, wheel_p), *next_p;
+
+		// Re-insert each timer relative to the current tick
+		for (; timer_p != NULL; timer_p = next_p) {
+			next_p = timer_p->next;
+			wheel_insert(timer_p, wheel_p);
+		}
+
+		// Only continue upward if this level wrapped as well
+		if (slot != 0) {
+			break;
+		}
+	}
+}
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+timer_wheel_t *make_timer_wheel (size_t capacity, uint64_t start_tick,
+	uint8_t *(*alloc)(size_t), void (*release)(uint8_t *))
+{
+	timer_wheel_t *wheel_p = NULL;
+	wheel_timer_t *timers = NULL;
+
+	// Parameter check
+	if (capacity == 0 || alloc == NULL || release == NULL) {
+		return NULL;
+	}
+
+	// Allocate wheel instance
+	if ((wheel_p = (timer_wheel_t *)alloc(sizeof(timer_wheel_t))) == NULL) {
+		return NULL;
+	}
+
+	// Allocate the timer pool
+	if ((timers = (wheel_timer_t *)alloc(capacity * sizeof(wheel_timer_t)))
+		== NULL) {
+		release((uint8_t *)wheel_p);
+		return NULL;
+	}
+
+	// Configure the wheel
+	memset(wheel_p, 0, sizeof(timer_wheel_t));
+	wheel_p->timers    = timers;
+	wheel_p->cap       = capacity;
+	wheel_p->len       = 0;
+	wheel_p->tick      = start_tick;
+	wheel_p->alloc     = alloc;
+	wheel_p->release   = release;
+
+	// Thread all timers onto the free list
+	for (off_t i = capacity - 1; i >= 0; --i) {
+		timers[i] = (wheel_timer_t) {
+			.next  = wheel_p->free_list,
+			.armed = false
+		};
+		wheel_p->free_list = timers + i;
+	}
+
+	return wheel_p;
+}
+
+
+int timer_wheel_add (uint64_t expiry, uint64_t period, void *data,
+	off_t *timer_id_p, timer_wheel_t *wheel_p)
+{
+	wheel_timer_t *timer_p = NULL;
+
+	// Parameter check
+	if (wheel_p == NULL) {
+		return 1;
+	}
+
+	// Capacity check
+	if ((timer_p = wheel_p->free_list) == NULL) {
+		return 2;
+	}
+
+	// Take the timer from the pool
+	wheel_p->free_list = timer_p->next;
+	wheel_p->len++;
+
+	// Configure and arm it
+	timer_p->expiry = expiry;
+	timer_p->period = period;
+	timer_p->data   = data;
+	timer_p->armed  = true;
+	wheel_insert(timer_p, wheel_p);
+
+	if (timer_id_p != NULL) {
+		*timer_id_p = (off_t)(timer_p - wheel_p->timers);
+	}
+
+	return 0;
+}
+
+
+int timer_wheel_cancel (off_t timer_id, void **data_p_p, timer_wheel_t *wheel_p)
+{
+	wheel_timer_t *timer_p = NULL;
+
+	// Parameter check
+	if (wheel_p == NULL || timer_id < 0 || timer_id >= wheel_p->cap) {
+		return 1;
+	}
+
+	// Check the timer is in use
+	if ((timer_p = wheel_p->timers + timer_id)->armed == false) {
+		return 2;
+	}
+
+	if (data_p_p != NULL) {
+		*data_p_p = timer_p->data;
+	}
+
+	wheel_remove(timer_p, wheel_p);
+	wheel_free(timer_p, wheel_p);
+
+	return 0;
+}
+
+
+int timer_wheel_advance (uint64_t now, void (*on_expiry)(off_t timer_id,
+	void *data, void *arg), void *arg, timer_wheel_t *wheel_p)
+{
+	int expired = 0;
+	uint64_t next;
+
+	// Parameter check
+	if (wheel_p == NULL || on_expiry == NULL) {
+		return -1;
+	}
+
+	while (wheel_p->tick <= now) {
+
+		// Skip directly to the next tick with work (if any before now)
+		if (timer_wheel_next_tick(&next, wheel_p) != 0 || next > now) {
+			wheel_p->tick = now + 1;
+			break;
+		}
+		wheel_p->tick = next;
+
+		// Cascade higher levels when the lowest level wraps
+		if ((next & TIMER_WHEEL_SLOT_MASK) == 0) {
+			wheel_cascade(wheel_p);
+		}
+
+		// Detach the due slot; timers added from here on go to later ticks
+		wheel_timer_t *timer_p = wheel_detach(0, next & TIMER_WHEEL_SLOT_MASK,
+			wheel_p), *next_p;
+		wheel_p->tick = next + 1;
+
+		for (; timer_p != NULL; timer_p = next_p) {
+			off_t timer_id = (off_t)(timer_p - wheel_p->timers);
+			void *data = timer_p->data;
+			next_p = timer_p->next;
+
+			// Clamped timers that aren't due yet go back into the wheel
+			if (timer_p->expiry > next) {
+				wheel_insert(timer_p, wheel_p);
+				continue;
+			}
+
+			// Re-arm periodic timers; free one-shot timers
+			if (timer_p->period != 0) {
+				timer_p->expiry += timer_p->period;
+				wheel_insert(timer_p, wheel_p);
+			} else {
+				wheel_free(timer_p, wheel_p);
+			}
+
+			on_expiry(timer_id, data, arg);
+			expired++;
+		}
+	}
+
+	return expired;
+}
+
+
+int timer_wheel_next_tick (uint64_t *tick_p, timer_wheel_t *wheel_p)
+{
+	uint64_t tick, bits, candidate = UINT64_MAX;
+
+	// Parameter check
+	if (tick_p == NULL || wheel_p == NULL) {
+		return 1;
+	}
+
+	// Nothing to do if there are no timers
+	if (wheel_p->len == 0) {
+		return 2;
+	}
+
+	tick = wheel_p->tick;
+	off_t index = tick & TIMER_WHEEL_SLOT_MASK;
+	uint64_t ticks_to_wrap = (index == 0) ? 0 : TIMER_WHEEL_SLOTS - index;
+
+	// Earliest occupied slot of the lowest level (this rotation, then next)
+	if ((bits = wheel_p->occupied[0] >> index) != 0) {
+		candidate = tick + __builtin_ctzll(bits);
+	} else if ((bits = wheel_p->occupied[0]) != 0) {
+		candidate = tick + ticks_to_wrap + __builtin_ctzll(bits);
+	}
+
+	// Timers in higher levels need a cascade when the lowest level wraps
+	for (off_t level = 1; level < TIMER_WHEEL_LEVELS; ++level) {
+		if (wheel_p->occupied[level] != 0) {
+			if (tick + ticks_to_wrap < candidate) {
+				candidate = tick + ticks_to_wrap;
+			}
+			break;
+		}
+	}
+
+	*tick_p = candidate;
+
+	return 0;
+}
+
+
+int destroy_timer_wheel (timer_wheel_t *wheel_p)
+{
+	// Parameter check
+	if (wheel_p == NULL) {
+		return 1;
+	}
+
+	// Free the timer pool
+	if (wheel_p->timers != NULL) {
+		wheel_p->release((uint8_t *)wheel_p->timers);
+	}
+
+	// Free the wheel itself
+	wheel_p->release((uint8_t *)wheel_p);
+
+	return 0;
+}
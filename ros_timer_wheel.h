@@ -0,0 +1,158 @@
+#if !defined(ROS_TIMER_WHEEL_H)
+#define ROS_TIMER_WHEEL_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 03/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Hierarchical timing wheel. Time is expressed in abstract ticks; the owner  *
+ *  decides how long a tick lasts and advances the wheel as time passes        *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <sys/types.h>
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Number of bits used to index the slots of a single level
+#define TIMER_WHEEL_SLOT_BITS        6
+
+// Number of slots per level
+#define TIMER_WHEEL_SLOTS            (1 << TIMER_WHEEL_SLOT_BITS)
+
+// Mask used to compute a slot index
+#define TIMER_WHEEL_SLOT_MASK        (TIMER_WHEEL_SLOTS - 1)
+
+// Number of levels (range is TIMER_WHEEL_SLOTS ^ TIMER_WHEEL_LEVELS ticks)
+#define TIMER_WHEEL_LEVELS           4
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Structure: Describes a single timer of the wheel
+typedef struct wheel_timer_t {
+	struct wheel_timer_t *next;         // Next timer in slot (or free list)
+	struct wheel_timer_t *prev;         // Previous timer in slot
+	uint64_t expiry;                    // Absolute expiry tick
+	uint64_t period;                    // Period in ticks (zero if one-shot)
+	void *data;                         // User data handed back on expiry
+	uint8_t level;                      // Level the timer is stored in
+	uint8_t slot;                       // Slot the timer is stored in
+	bool armed;                         // True if the timer is in the wheel
+} wheel_timer_t;
+
+
+// Structure: Describes a hierarchical timing wheel
+typedef struct {
+	wheel_timer_t *timers;              // Pool of timers
+	wheel_timer_t *free_list;           // Unused timers of the pool
+	size_t cap;                         // Capacity of the pool
+	size_t len;                         // Number of timers in use
+	uint64_t tick;                      // Next tick to be processed
+
+	// Slot lists and occupancy bitmaps for each level
+	wheel_timer_t *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	uint64_t occupied[TIMER_WHEEL_LEVELS];
+
+	uint8_t *(*alloc)(size_t size);     // Allocator for more memory
+	void (*release)(uint8_t *mem_ptr);  // Deallocator for memory
+} timer_wheel_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Creates a timer wheel with the given allocator
+ * @param capacity Maximum number of concurrent timers
+ * @param start_tick Tick at which the wheel starts
+ * @param alloc Pointer to memory allocation routine
+ * @param release Pointer to memory de-allocation routine
+ * @return NULL on error; else valid pointer to timer_wheel_t instance
+\*/
+timer_wheel_t *make_timer_wheel (size_t capacity, uint64_t start_tick,
+	uint8_t *(*alloc)(size_t), void (*release)(uint8_t *));
+
+
+/*\
+ * @brief Adds a timer to the wheel
+ * @note  Expiries in the past fire on the next call to advance
+ * @param expiry Absolute tick at which the timer first expires
+ * @param period Period in ticks for periodic timers; zero for one-shot
+ * @param data User data handed to the expiry routine
+ * @param timer_id_p Pointer at which to store the timer ID (may be NULL)
+ * @param wheel_p Pointer to the wheel
+ * @return Zero on success; 1 on bad param; 2 on reached capacity
+\*/
+int timer_wheel_add (uint64_t expiry, uint64_t period, void *data,
+	off_t *timer_id_p, timer_wheel_t *wheel_p);
+
+
+/*\
+ * @brief Cancels and frees a timer
+ * @param timer_id ID of the timer to cancel
+ * @param data_p_p Pointer at which to store the timer user data (may be NULL)
+ * @param wheel_p Pointer to the wheel
+ * @return Zero on success; 1 on bad param; 2 if the timer isn't in use
+\*/
+int timer_wheel_cancel (off_t timer_id, void **data_p_p, timer_wheel_t *wheel_p);
+
+
+/*\
+ * @brief Advances the wheel up to and including the given tick, invoking the
+ *        expiry routine for every timer that fires. Periodic timers are 
+ *        re-armed before the routine is invoked; one-shot timers are freed
+ *        before it is invoked
+ * @param now Tick to advance to
+ * @param on_expiry Routine invoked with the timer ID, its user data and arg
+ * @param arg Argument passed through to the expiry routine
+ * @param wheel_p Pointer to the wheel
+ * @return Number of expired timers; -1 on bad param
+\*/
+int timer_wheel_advance (uint64_t now, void (*on_expiry)(off_t timer_id,
+	void *data, void *arg), void *arg, timer_wheel_t *wheel_p);
+
+
+/*\
+ * @brief Returns the next tick at which the wheel must be advanced
+ * @note  May be earlier than the next expiry when timers must be cascaded
+ * @param tick_p Pointer at which to store the tick
+ * @param wheel_p Pointer to the wheel
+ * @return Zero on success; 1 on bad param; 2 if the wheel is empty
+\*/
+int timer_wheel_next_tick (uint64_t *tick_p, timer_wheel_t *wheel_p);
+
+
+/*\
+ * @brief Frees memory associated with the wheel
+ * @param wheel_p Pointer to the wheel
+ * @return Zero on success; 1 on bad parameter
+\*/
+int destroy_timer_wheel (timer_wheel_t *wheel_p);
+
+
+#endif
@@ -0,0 +1,118 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+
+#include "ros_timer_wheel.h"
+#include "ros_static_allocator.h"
+
+#define MEM_SIZE      (1 << 20)
+#define N_TIMERS      4096
+#define N_TICKS       (1 << 20)
+
+// Memory bank
+uint8_t g_memory[MEM_SIZE];
+
+// Allocator
+static_allocator_t *g_allocator = NULL;
+
+// Expected next expiry and period of each timer
+uint64_t g_expected[N_TIMERS];
+uint64_t g_period[N_TIMERS];
+
+// Tick the wheel is advanced to
+uint64_t g_now = 0;
+
+// Number of expiries seen
+size_t g_fired = 0;
+
+
+uint8_t *alloc (size_t size)
+{
+	return static_alloc(g_allocator, size);
+}
+
+void release (uint8_t *ptr)
+{
+	static_free(g_allocator, ptr);
+}
+
+void on_expiry (off_t timer_id, void *data, void *arg)
+{
+	off_t index = (off_t)(uintptr_t)data;
+	uint64_t tick = ((timer_wheel_t *)arg)->tick - 1;
+
+	// A timer must fire exactly in the tick it was due in
+	if (g_expected[index] != tick) {
+		fprintf(stderr, "Timer %ld fired at %lu instead of %lu\n", index,
+			tick, g_expected[index]);
+		exit(EXIT_FAILURE);
+	}
+
+	g_expected[index] += g_period[index];
+	g_fired++;
+}
+
+int main (void)
+{
+	timer_wheel_t *wheel_p = NULL;
+	off_t timer_id;
+	uint64_t next;
+
+	// Seed random generator
+	srand((unsigned)time(NULL));
+
+	// Setup static allocator + wheel
+	g_allocator = install_static_allocator(g_memory, MEM_SIZE);
+	assert((wheel_p = make_timer_wheel(N_TIMERS, 0, alloc, release)) != NULL);
+
+	// Arm a mix of short, long and out-of-range periodic timers
+	for (off_t i = 0; i < N_TIMERS; ++i) {
+		switch (i % 3) {
+			case 0: g_period[i] = 1 + rand() % 64;           break;
+			case 1: g_period[i] = 1 + rand() % 100000;       break;
+			case 2: g_period[i] = (1 << 24) + rand() % 1000; break;
+		}
+		g_expected[i] = rand() % 5000;
+		assert(timer_wheel_add(g_expected[i], g_period[i], (void *)(uintptr_t)i,
+			&timer_id, wheel_p) == 0);
+	}
+
+	// Wheel is full
+	assert(timer_wheel_add(0, 0, NULL, NULL, wheel_p) == 2);
+
+	// Advance in random steps, checking nothing is overdue afterwards
+	while (g_now < N_TICKS) {
+		g_now += 1 + rand() % 200;
+		timer_wheel_advance(g_now, on_expiry, wheel_p, wheel_p);
+
+		for (off_t i = 0; i < N_TIMERS; ++i) {
+			if (g_expected[i] <= g_now) {
+				fprintf(stderr, "Timer %ld is overdue (%lu <= %lu)\n", i,
+					g_expected[i], g_now);
+				return EXIT_FAILURE;
+			}
+		}
+
+		// The next tick must never be later than the next expiry
+		assert(timer_wheel_next_tick(&next, wheel_p) == 0);
+		for (off_t i = 0; i < N_TIMERS; ++i) {
+			assert(next <= g_expected[i]);
+		}
+	}
+
+	printf("%zu expiries over %lu ticks\n", g_fired, g_now);
+
+	// Cancel everything
+	for (off_t i = 0; i < N_TIMERS; ++i) {
+		assert(timer_wheel_cancel(i, NULL, wheel_p) == 0);
+	}
+	assert(timer_wheel_cancel(0, NULL, wheel_p) == 2);
+	assert(timer_wheel_next_tick(&next, wheel_p) == 2);
+
+	// Destroy the wheel
+	assert(destroy_timer_wheel(wheel_p) == 0);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+#include "ros_trace.h"
+
+/*
+ *******************************************************************************
+ *                              Global Variables                               *
+ *******************************************************************************
+*/
+
+
+// The mapped rings, and the ring of this process (NULL until attached)
+static trace_buffer_t *g_trace_buffer = NULL;
+static trace_ring_t *g_trace_ring = NULL;
+
+/*
+ *******************************************************************************
+ *                            Prototype Definitions                            *
+ *******************************************************************************
+*/
+
+
+int trace_open (bool is_owner)
+{
+	if ((g_trace_buffer = (trace_buffer_t *)map_shared_memory(TRACE_SHM_NAME,
+		sizeof(trace_buffer_t), is_owner)) == NULL) {
+		return 1;
+	}
+
+	if (is_owner) {
+		memset(g_trace_buffer, 0, sizeof(trace_buffer_t));
+		g_trace_buffer->start_ns = time_now_ns();
+	}
+
+	return 0;
+}
+
+
+int trace_attach (off_t task_id)
+{
+	int pid = getpid(), expected;
+
+	// Anything inherited belongs to the parent
+	g_trace_ring = NULL;
+
+	if (g_trace_buffer == NULL) {
+		return 1;
+	}
+
+	// Take a free ring, or one whose writer has exited
+	for (off_t i = 0; i < TRACE_MAX_RINGS; ++i) {
+		trace_ring_t *ring_p = g_trace_buffer->rings + i;
+
+		expected = atomic_load(&(ring_p->owner));
+		if (expected != 0 && (kill(expected, 0) == 0 || errno != ESRCH)) {
+			continue;
+		}
+		if (atomic_compare_exchange_strong(&(ring_p->owner), &expected, pid)) {
+			ring_p->task_id = (int32_t)task_id;
+			atomic_store(&(ring_p->head), 0);
+			g_trace_ring = ring_p;
+			return 0;
+		}
+	}
+
+	fprintf(stderr, "%s:%d: No trace ring left for process %d\n",
+		__FILE__, __LINE__, pid);
+
+	return 2;
+}
+
+
+void trace_event (trace_type_t type, off_t task_id, uint64_t arg)
+{
+	trace_ring_t *ring_p = g_trace_ring;
+	uint64_t head;
+
+	if (ring_p == NULL) {
+		return;
+	}
+
+	// Single writer: fill the slot, then publish it
+	head = atomic_load_explicit(&(ring_p->head), memory_order_relaxed);
+	ring_p->events[head & (TRACE_RING_LEN - 1)] = (trace_event_t) {
+		.ts_ns   = time_now_ns(),
+		.arg     = arg,
+		.task_id = (int32_t)task_id,
+		.type    = (uint16_t)type
+	};
+	atomic_store_explicit(&(ring_p->head), head + 1, memory_order_release);
+}
+
+
+const char *trace_type_name (trace_type_t type)
+{
+	static const char *names[TRACE_TYPE_COUNT] = {
+		[TRACE_ARRIVAL]  = "arrival",
+		[TRACE_ENQUEUE]  = "enqueue",
+		[TRACE_SCHEDULE] = "schedule",
+		[TRACE_STOP]     = "sigstop",
+		[TRACE_CONT]     = "sigcont",
+		[TRACE_WAKE]     = "wake",
+		[TRACE_CB_START] = "callback",
+		[TRACE_CB_END]   = "callback",
+		[TRACE_FREE]     = "free"
+	};
+
+	return (type < TRACE_TYPE_COUNT) ? names[type] : "unknown";
+}
+
+
+int trace_close (bool is_owner)
+{
+	if (g_trace_buffer == NULL) {
+		return 0;
+	}
+
+	if (unmap_shared_memory(TRACE_SHM_NAME, g_trace_buffer,
+		sizeof(trace_buffer_t), is_owner) != 0) {
+		return 1;
+	}
+	g_trace_buffer = NULL;
+	g_trace_ring = NULL;
+
+	return 0;
+}
@@ -0,0 +1,155 @@
+#if !defined(ROS_TRACE_H)
+#define ROS_TRACE_H
+
+/*
+ *******************************************************************************
+ *                          (C) Copyright 2020 TUDelft                         *
+ * Created: 11/08/2020                                                         *
+ *                                                                             *
+ * Programmer(s):                                                              *
+ * - Charles Randolph                                                          *
+ *                                                                             *
+ * Description:                                                                *
+ *  Binary event trace. Each process owns a ring in a shared memory map and    *
+ *  is its only writer; TRACE() compiles to nothing unless ROS_TRACE is set    *
+ *                                                                             *
+ *******************************************************************************
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+
+#include "ros_exec_shm.h"
+#include "ros_time.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Name of the shared memory map holding the rings
+#define TRACE_SHM_NAME               "ros_exec_trace"
+
+// Number of rings (processes traced at once)
+#define TRACE_MAX_RINGS              64
+
+// Events per ring (a power of two; the oldest are overwritten)
+#define TRACE_RING_LEN               8192
+
+// Records an event (compiled out unless built with -DROS_TRACE)
+#if defined(ROS_TRACE)
+#define TRACE(type, task_id, arg)    trace_event((type), (task_id), (arg))
+#else
+#define TRACE(type, task_id, arg)    ((void)0)
+#endif
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Enumeration: Kinds of trace events (arg in brackets)
+typedef enum {
+	TRACE_ARRIVAL = 0,                  // Callback offered to a task [prio]
+	TRACE_ENQUEUE,                      // Callback queued [queue length]
+	TRACE_SCHEDULE,                     // Task picked to run [preempted task]
+	TRACE_STOP,                         // SIGSTOP sent to a task [pid]
+	TRACE_CONT,                         // SIGCONT sent to a task [pid]
+	TRACE_WAKE,                         // Worker resumed [0]
+	TRACE_CB_START,                     // Callback started [arrival (ns)]
+	TRACE_CB_END,                       // Callback completed [arrival (ns)]
+	TRACE_FREE,                         // Callback descriptor freed [0]
+	TRACE_TYPE_COUNT
+} trace_type_t;
+
+
+// Structure: A trace event
+typedef struct {
+	uint64_t ts_ns;                     // CLOCK_MONOTONIC timestamp
+	uint64_t arg;                       // Event argument (see trace_type_t)
+	int32_t task_id;                    // Task concerned (-1 if none)
+	uint16_t type;                      // Kind of event
+	uint16_t reserved;
+} trace_event_t;
+
+
+// Structure: Ring of the events of a single process
+typedef struct {
+	atomic_int owner;                   // PID of the writer (0 if free)
+	int32_t task_id;                    // Task served by it (-1: executor)
+	atomic_uint_least64_t head;         // Events written so far
+	trace_event_t events[TRACE_RING_LEN];
+} trace_ring_t;
+
+
+// Structure: All rings
+typedef struct {
+	uint64_t start_ns;                  // Time the trace was opened
+	trace_ring_t rings[TRACE_MAX_RINGS];
+} trace_buffer_t;
+
+/*
+ *******************************************************************************
+ *                           Interface Declarations                            *
+ *******************************************************************************
+*/
+
+
+/*\
+ * @brief Maps the trace rings. The owner creates (and clears) them; forked
+ *        children inherit the mapping
+ * @param is_owner True if the caller creates the map
+ * @return Zero on success; 1 if the map is unavailable
+\*/
+int trace_open (bool is_owner);
+
+
+/*\
+ * @brief Claims a ring for the calling process. Must be called again in
+ *        the child after a fork (until then its events are not recorded)
+ * @param task_id The task served by the process (-1 for the executor)
+ * @return Zero on success; 1 if not open, 2 if all rings are taken
+\*/
+int trace_attach (off_t task_id);
+
+
+/*\
+ * @brief Appends an event to the ring of the calling process (lock-free,
+ *        as each ring has a single writer). Use TRACE() instead
+ * @param type    The kind of event
+ * @param task_id The task concerned (-1 if none)
+ * @param arg     The event argument
+ * @return None
+\*/
+void trace_event (trace_type_t type, off_t task_id, uint64_t arg);
+
+
+/*\
+ * @brief Returns the name of an event type
+ * @param type The kind of event
+ * @return Name of the event
+\*/
+const char *trace_type_name (trace_type_t type);
+
+
+/*\
+ * @brief Unmaps the trace rings (removing the map if the owner)
+ * @param is_owner True if the caller created the map
+ * @return Zero on success; 1 on error
+\*/
+int trace_close (bool is_owner);
+
+
+#endif
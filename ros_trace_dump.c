@@ -0,0 +1,188 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "ros_trace.h"
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Structure: An event along with the process that recorded it
+typedef struct {
+	trace_event_t event;
+	int pid;
+} dump_event_t;
+
+/*
+ *******************************************************************************
+ *                              Support Functions                              *
+ *******************************************************************************
+*/
+
+
+static int compare_events (const void *a, const void *b)
+{
+	const dump_event_t *x = (const dump_event_t *)a;
+	const dump_event_t *y = (const dump_event_t *)b;
+
+	return (x->event.ts_ns > y->event.ts_ns) - (x->event.ts_ns < y->event.ts_ns);
+}
+
+// Copies the events still held by a ring. Writers may keep going, so events
+// overwritten during the copy are dropped
+static size_t copy_ring (const trace_ring_t *ring_p, int pid,
+	dump_event_t *out)
+{
+	uint64_t head, first, last, after;
+	size_t n = 0;
+
+	head  = atomic_load_explicit((atomic_uint_least64_t *)&(ring_p->head),
+		memory_order_acquire);
+	first = (head > TRACE_RING_LEN) ? head - TRACE_RING_LEN : 0;
+
+	for (uint64_t i = first; i < head; ++i) {
+		out[n++] = (dump_event_t) {
+			.event = ring_p->events[i & (TRACE_RING_LEN - 1)],
+			.pid   = pid
+		};
+	}
+
+	// Events the writer lapped meanwhile may be torn
+	after = atomic_load_explicit((atomic_uint_least64_t *)&(ring_p->head),
+		memory_order_acquire);
+	last  = (after > TRACE_RING_LEN) ? after - TRACE_RING_LEN : 0;
+	if (last > first) {
+		size_t lost = (last - first < n) ? last - first : n;
+		memmove(out, out + lost, (n - lost) * sizeof(dump_event_t));
+		n -= lost;
+	}
+
+	return n;
+}
+
+// Writes one event in the Chrome trace event format
+static void write_event (FILE *file_p, const dump_event_t *e,
+	uint64_t start_ns, bool *first_p)
+{
+	const char *name = trace_type_name(e->event.type);
+	double ts_us = (e->event.ts_ns - start_ns) / 1e3;
+
+	fprintf(file_p, "%s\n  {\"name\": \"%s\", \"cat\": \"executor\", ",
+		*first_p ? "" : ",", name);
+	*first_p = false;
+
+	switch (e->event.type) {
+
+		// Callbacks are spans on the track of the worker
+		case TRACE_CB_START:
+		case TRACE_CB_END:
+			fprintf(file_p, "\"ph\": \"%s\", ",
+				(e->event.type == TRACE_CB_START) ? "B" : "E");
+			break;
+
+		default:
+			fprintf(file_p, "\"ph\": \"i\", \"s\": \"t\", ");
+			break;
+	}
+
+	fprintf(file_p, "\"pid\": %d, \"tid\": %d, \"ts\": %.3f, \"args\": "
+		"{\"task\": %d, \"arg\": %" PRIu64 "}}", e->pid, e->pid, ts_us,
+		e->event.task_id, e->event.arg);
+}
+
+/*
+ *******************************************************************************
+ *                                    Main                                     *
+ *******************************************************************************
+*/
+
+
+int main (int argc, char *argv[])
+{
+	const trace_buffer_t *buffer_p = NULL;
+	dump_event_t *events = NULL;
+	FILE *file_p = stdout;
+	size_t n = 0;
+	bool first = true;
+	int fd = -1;
+
+	// Check arguments
+	if (argc > 2) {
+		printf("%s [trace.json]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	// Map the rings (read-only, while the executor may still be running)
+	if ((fd = shm_open(TRACE_SHM_NAME, O_RDONLY, 0)) == -1) {
+		perror("shm_open");
+		return EXIT_FAILURE;
+	}
+	if ((buffer_p = mmap(NULL, sizeof(trace_buffer_t), PROT_READ, MAP_SHARED,
+		fd, 0)) == MAP_FAILED) {
+		perror("mmap");
+		return EXIT_FAILURE;
+	}
+	close(fd);
+
+	if ((events = malloc(TRACE_MAX_RINGS * TRACE_RING_LEN *
+		sizeof(dump_event_t))) == NULL) {
+		perror("malloc");
+		return EXIT_FAILURE;
+	}
+
+	if (argc == 2 && (file_p = fopen(argv[1], "w")) == NULL) {
+		perror("fopen");
+		return EXIT_FAILURE;
+	}
+
+	fprintf(file_p, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+
+	// Name the process tracks, and gather the events of every ring
+	for (off_t i = 0; i < TRACE_MAX_RINGS; ++i) {
+		const trace_ring_t *ring_p = buffer_p->rings + i;
+		int pid = atomic_load((atomic_int *)&(ring_p->owner));
+
+		if (pid == 0) {
+			continue;
+		}
+
+		fprintf(file_p, "%s\n  {\"name\": \"process_name\", \"ph\": \"M\", "
+			"\"pid\": %d, \"args\": {\"name\": ", first ? "" : ",", pid);
+		if (ring_p->task_id == -1) {
+			fprintf(file_p, "\"executor\"}}");
+		} else {
+			fprintf(file_p, "\"task %d\"}}", ring_p->task_id);
+		}
+		first = false;
+
+		n += copy_ring(ring_p, pid, events + n);
+	}
+
+	// One timeline across all processes
+	qsort(events, n, sizeof(dump_event_t), compare_events);
+	for (off_t i = 0; i < n; ++i) {
+		write_event(file_p, events + i, buffer_p->start_ns, &first);
+	}
+
+	fprintf(file_p, "\n]}\n");
+
+	if (file_p != stdout) {
+		fclose(file_p);
+		fprintf(stderr, "Wrote %zu events to %s\n", n, argv[1]);
+	}
+
+	free(events);
+	munmap((void *)buffer_p, sizeof(trace_buffer_t));
+
+	return EXIT_SUCCESS;
+}
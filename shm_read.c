@@ -3,53 +3,301 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
+#include <signal.h>
 
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
 
-int main (void)
+#include "ros_exec_shm.h"
+#include "ros_static_allocator.h"
+#include "ros_task_stats.h"
+
+/*
+ *******************************************************************************
+ *                             Symbolic Constants                              *
+ *******************************************************************************
+*/
+
+
+// Default refresh interval of the view
+#define DEFAULT_REFRESH_MS           1000
+
+// Most free blocks walked before the free list is deemed in flux
+#define MAX_FREE_BLOCKS              65536
+
+/*
+ *******************************************************************************
+ *                              Type Definitions                               *
+ *******************************************************************************
+*/
+
+
+// Structure: Free memory of the allocator, as seen by a walk
+typedef struct {
+	size_t free_bytes;                  // Free bytes (allocator counter)
+	size_t blocks;                      // Free blocks on the list
+	size_t largest;                     // Largest free block (bytes)
+	bool valid;                         // False if the walk was torn
+} alloc_view_t;
+
+/*
+ *******************************************************************************
+ *                              Support Functions                              *
+ *******************************************************************************
+*/
+
+
+static uint64_t monotonic_ns (void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// Walks the free list of the allocator without its lock. The executor may
+// change the list meanwhile, so every link is checked and the walk bounded
+static alloc_view_t view_allocator (const void *shm_ptr,
+	const exec_shm_header_t *header_p)
 {
-	const char *name = "ros_exec_map";
-	int oflag = O_RDONLY;
-	mode_t mode = 0;
-	int err, fd = -1;
-	size_t size = 1024;
+	const static_allocator_t *allocator_p = (const static_allocator_t *)
+		((const uint8_t *)shm_ptr + header_p->allocator_offset);
+	const block_h *head_p = NULL, *block_p = NULL;
+	alloc_view_t view = {.free_bytes = allocator_p->free_memory_size};
+
+	// Nothing allocated yet
+	if (allocator_p->free_list == NULL) {
+		view.largest = view.free_bytes;
+		view.valid = true;
+		return view;
+	}
+
+	if ((head_p = shm_rebase(shm_ptr, allocator_p->free_list)) == NULL) {
+		return view;
+	}
+
+	block_p = head_p;
+	for (off_t i = 0; i < MAX_FREE_BLOCKS; ++i) {
+		size_t bytes = block_p->d.size * allocator_p->unit_size;
+
+		if (bytes > 0) {
+			view.blocks++;
+			if (bytes > view.largest) {
+				view.largest = bytes;
+			}
+		}
+
+		if ((block_p = shm_rebase(shm_ptr, block_p->d.next)) == NULL) {
+			return view;
+		}
+		if (block_p == head_p) {
+			view.valid = true;
+			return view;
+		}
+	}
+
+	return view;
+}
+
+// Draws one frame of the view
+static void show_view (const void *shm_ptr, const exec_shm_header_t *header_p,
+	const task_stats_t *stats_p, const task_stats_t *last_p, uint64_t dt_ns)
+{
+	alloc_view_t alloc = view_allocator(shm_ptr, header_p);
+	const task_stats_t *shared_p = (const task_stats_t *)
+		((const uint8_t *)shm_ptr + header_p->stats_offset);
+
+	// Clear the terminal
+	printf("\033[H\033[2J");
+
+	printf("Executor %d | %s mode%s | %" PRIu64 " publications\n",
+		header_p->executor_pid, stats_p->hi_mode ? "HI" : "LO",
+		stats_p->overloaded ? " | OVERLOADED" : "", stats_p->publications);
+
+	if (stats_p->running_task_id == -1) {
+		printf("Running: <idle>\n");
+	} else {
+		printf("Running: task %ld\n", stats_p->running_task_id);
+	}
+
+	if (alloc.valid) {
+		printf("Memory:  %zu bytes free in %zu blocks, largest %zu "
+			"(fragmentation %.1f%%)\n", alloc.free_bytes, alloc.blocks,
+			alloc.largest, (alloc.free_bytes == 0) ? 0.0 :
+			100.0 * (1.0 - (double)alloc.largest / alloc.free_bytes));
+	} else {
+		printf("Memory:  %zu bytes free (free list in flux)\n",
+			alloc.free_bytes);
+	}
+
+	printf("\n%5s %7s %7s %9s %10s %10s %10s %13s %s\n", "task", "pid",
+		"queue", "disp/s", "wait99(us)", "resp50(us)", "resp99(us)",
+		"misses/done", "state");
+
+	for (off_t i = 0; i < stats_p->len; ++i) {
+		const task_stats_entry_t *t = stats_p->tasks + i;
+		uint64_t q99_ns = 0, p50_ns = 0, p99_ns = 0;
+		uint64_t dispatched = t->dispatches;
+		char q99[24] = "-", p50[24] = "-", p99[24] = "-";
+
+		if (!t->registered) {
+			continue;
+		}
+
+		// Rate since the last frame
+		if (i < last_p->len) {
+			dispatched -= last_p->tasks[i].dispatches;
+		}
+
+		// Queueing tail, and the response time (arrival to completion)
+		if (task_stats_latency_percentile(i, TASK_LATENCY_QUEUEING, 99.0,
+			&q99_ns, shared_p) == 0 &&
+			task_stats_latency_percentile(i, TASK_LATENCY_RESPONSE, 50.0,
+			&p50_ns, shared_p) == 0 &&
+			task_stats_latency_percentile(i, TASK_LATENCY_RESPONSE, 99.0,
+			&p99_ns, shared_p) == 0) {
+			snprintf(q99, sizeof(q99), "%" PRIu64, q99_ns / 1000);
+			snprintf(p50, sizeof(p50), "%" PRIu64, p50_ns / 1000);
+			snprintf(p99, sizeof(p99), "%" PRIu64, p99_ns / 1000);
+		}
+
+		printf("%5ld %7d %3zu/%-3zu %9.1f %10s %10s %10s %6" PRIu64 "/%-6"
+			PRIu64 " %s\n", i, t->pid, t->queue_len, t->queue_cap,
+			(dt_ns == 0) ? 0.0 : dispatched * 1e9 / dt_ns, q99, p50, p99,
+			t->misses, t->completions,
+			(i == stats_p->running_task_id) ? "running" : (t->active ?
+			"preempted" : (t->stopped ? "stopped" : "ready")));
+	}
+
+	if (stats_p->dropped > 0) {
+		printf("(%zu more tasks not shown)\n", stats_p->dropped);
+	}
+
+	// Performance counters per callback (only if the executor counts them)
+	for (off_t i = 0, shown = 0; i < stats_p->len; ++i) {
+		perf_sample_t mean;
+		uint64_t kinstr;
+
+		if (!stats_p->tasks[i].registered ||
+			task_stats_perf_mean(i, &mean, shared_p) != 0) {
+			continue;
+		}
+		if (shown++ == 0) {
+			printf("\n%5s %14s %14s %6s %14s %10s\n", "task", "cycles/cb",
+				"instr/cb", "IPC", "miss/kinstr", "ctxsw/cb");
+		}
+		kinstr = mean.counts[PERF_INSTRUCTIONS] / 1000;
+		printf("%5ld %14" PRIu64 " %14" PRIu64 " %6.2f %14.2f %10" PRIu64 "\n",
+			i, mean.counts[PERF_CYCLES], mean.counts[PERF_INSTRUCTIONS],
+			(mean.counts[PERF_CYCLES] == 0) ? 0.0 :
+			(double)mean.counts[PERF_INSTRUCTIONS] / mean.counts[PERF_CYCLES],
+			(kinstr == 0) ? 0.0 : (double)mean.counts[PERF_CACHE_MISSES] /
+			kinstr, mean.counts[PERF_CONTEXT_SWITCHES]);
+	}
+
+	fflush(stdout);
+}
+
+/*
+ *******************************************************************************
+ *                                    Main                                     *
+ *******************************************************************************
+*/
+
+
+int main (int argc, char *argv[])
+{
+	const char *name = EXEC_SHM_NAME;
+	unsigned long refresh_ms = DEFAULT_REFRESH_MS, refreshes = 0;
+	static task_stats_t stats, last;
+	exec_shm_header_t *header_p = NULL;
+	uint64_t last_ns;
+	int fd = -1;
+	size_t size = 0;
 	void *ptr = NULL;
 
-	// Open POSIX shared memory map (initially length = 0)
-	if ((fd = shm_open(name, oflag, mode)) == -1) {
+	// Check arguments
+	if (argc > 3) {
+		printf("%s [refresh-ms] [refreshes (0: forever)]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+	if (argc >= 2) {
+		refresh_ms = strtoul(argv[1], NULL, 10);
+	}
+	if (argc == 3) {
+		refreshes = strtoul(argv[2], NULL, 10);
+	}
+	if (refresh_ms == 0) {
+		refresh_ms = DEFAULT_REFRESH_MS;
+	}
+
+	// Open the executor's map (read-only: the monitor never takes a lock)
+	if ((fd = shm_open(name, O_RDONLY, 0)) == -1) {
 		perror("shm_open");
 		return EXIT_FAILURE;
 	}
 
 	// Get size
 	struct stat sb;
-	fstat(fd, &sb);
-	size = sb.st_size;
-	printf("Found the shared memory map with a size of %zu\n", size);
-
-	// Map it 
-	void *start_addr = NULL;
-	int prot         = PROT_READ;
-	int flags        = MAP_SHARED;
-	off_t offset     = 0x0;
-	if ((ptr = mmap(start_addr, size, prot, flags, fd, offset)) == MAP_FAILED) {
+	if (fstat(fd, &sb) == -1 || (size = sb.st_size) <
+		sizeof(exec_shm_header_t)) {
+		fprintf(stderr, "The shared memory map is not ready\n");
+		return EXIT_FAILURE;
+	}
+
+	// Map it
+	if ((ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
 		perror("mmap");
 		return EXIT_FAILURE;
 	}
+	close(fd);
 
-	// Print the text in it
-	printf("Text = \"%s\"\n", (char *)ptr);
+	// The executor writes the magic once the map is laid out
+	header_p = (exec_shm_header_t *)ptr;
+	if (header_p->magic != EXEC_SHM_MAGIC || header_p->size > size ||
+		header_p->stats_offset + sizeof(task_stats_t) > size) {
+		fprintf(stderr, "No executor state in the shared memory map\n");
+		munmap(ptr, size);
+		return EXIT_FAILURE;
+	}
+
+	// Refresh until told to stop (or the executor exits)
+	struct timespec interval = {
+		.tv_sec  = refresh_ms / 1000,
+		.tv_nsec = (refresh_ms % 1000) * 1000000
+	};
+	read_task_stats(&last, (const task_stats_t *)((uint8_t *)ptr +
+		header_p->stats_offset));
+	last_ns = monotonic_ns();
+	for (unsigned long n = 0; refreshes == 0 || n < refreshes; ++n) {
+		const task_stats_t *shared_p = (const task_stats_t *)
+			((uint8_t *)ptr + header_p->stats_offset);
+		uint64_t now_ns;
+
+		nanosleep(&interval, NULL);
 
-	// Unmap it
-	if ((err = munmap(ptr, size)) == -1) {
+		if (kill(header_p->executor_pid, 0) == -1 && errno == ESRCH) {
+			printf("Executor %d exited\n", header_p->executor_pid);
+			break;
+		}
+		if (read_task_stats(&stats, shared_p) != 0) {
+			continue;
+		}
+
+		now_ns = monotonic_ns();
+		show_view(ptr, header_p, &stats, &last, now_ns - last_ns);
+		last = stats;
+		last_ns = now_ns;
+	}
+
+	// Unmap it (don't unlink: the executor owns it)
+	if (munmap(ptr, size) == -1) {
 		perror("munmap");
 		return EXIT_FAILURE;
 	}
 
-	// Don't unlink (don't own it)
-
-	// Terminate program
 	return EXIT_SUCCESS;
-}
\ No newline at end of file
+}